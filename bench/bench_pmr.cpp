@@ -0,0 +1,111 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/tiltyard_Cpp.hpp"
+
+/* Compares containers allocating from tiltyard with the standard resources.
+ *
+ * Every workload fills a container and destroys it, over and over, with
+ * its memory coming from global new, a std::pmr::monotonic_buffer_resource,
+ * a tiltyard::MemoryResource and a tiltyard::Allocator. The monotonic
+ * resource and the arena are released after every round.
+ *
+ * Usage: bench_pmr [elements] [rounds]
+ */
+
+static std::size_t elements = 1000 * 1000;
+static std::size_t rounds = 20;
+
+static double now()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* Runs 'round' 'rounds' times, calling 'release' after every round,
+ * and prints the nanoseconds per element.
+ */
+template <class Round, class Release>
+static void run(const char *workload, const char *resource, Round round, Release release)
+{
+	std::size_t sink = 0;
+
+	double start = now();
+	for (std::size_t i = 0; i < rounds; i++) {
+		sink += round();
+		release();
+	}
+	double elapsed = now() - start;
+
+	std::printf("%-14s %-22s %10.2f ns/elem %12zu\n", workload, resource,
+		    elapsed * 1e9 / (double)(rounds * elements), sink);
+}
+
+template <class Vector>
+static std::size_t fill_vector(Vector vector)
+{
+	for (std::size_t i = 0; i < elements; i++)
+		vector.push_back((int)i);
+	return vector.size();
+}
+
+template <class List>
+static std::size_t fill_list(List list)
+{
+	for (std::size_t i = 0; i < elements; i++)
+		list.push_back((int)i);
+	return list.size();
+}
+
+template <class Map>
+static std::size_t fill_map(Map map)
+{
+	for (std::size_t i = 0; i < elements / 4; i++)
+		map[(int)i] = (int)i;
+	return map.size();
+}
+
+int main(int argc, char **argv)
+{
+	if (argc > 1) elements = std::strtoul(argv[1], nullptr, 10);
+	if (argc > 2) rounds = std::strtoul(argv[2], nullptr, 10);
+
+	tiltyard::ArenaPtr arena = tiltyard::make_virtual_arena((std::size_t)4 * 1024 * 1024 * 1024, 1024 * 1024);
+	tiltyard::MemoryResource arena_resource(arena.get());
+	tiltyard::Allocator<int> allocator(arena.get());
+	std::pmr::monotonic_buffer_resource monotonic;
+
+	auto nothing = [] {};
+	auto release_monotonic = [&] { monotonic.release(); };
+	auto release_arena = [&] { tiltyard_reset(arena.get()); };
+
+	std::printf("%-14s %-22s %18s %12s\n", "workload", "resource", "time", "sink");
+
+	run("vector", "new/delete", [] { return fill_vector(std::vector<int>()); }, nothing);
+	run("vector", "monotonic_buffer", [&] { return fill_vector(std::pmr::vector<int>(&monotonic)); }, release_monotonic);
+	run("vector", "tiltyard resource", [&] { return fill_vector(std::pmr::vector<int>(&arena_resource)); }, release_arena);
+	run("vector", "tiltyard allocator",
+	    [&] { return fill_vector(std::vector<int, tiltyard::Allocator<int>>(allocator)); }, release_arena);
+
+	run("list", "new/delete", [] { return fill_list(std::list<int>()); }, nothing);
+	run("list", "monotonic_buffer", [&] { return fill_list(std::pmr::list<int>(&monotonic)); }, release_monotonic);
+	run("list", "tiltyard resource", [&] { return fill_list(std::pmr::list<int>(&arena_resource)); }, release_arena);
+	run("list", "tiltyard allocator",
+	    [&] { return fill_list(std::list<int, tiltyard::Allocator<int>>(allocator)); }, release_arena);
+
+	using ArenaMap = std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+					    tiltyard::Allocator<std::pair<const int, int>>>;
+	run("unordered_map", "new/delete", [] { return fill_map(std::unordered_map<int, int>()); }, nothing);
+	run("unordered_map", "monotonic_buffer",
+	    [&] { return fill_map(std::pmr::unordered_map<int, int>(&monotonic)); }, release_monotonic);
+	run("unordered_map", "tiltyard resource",
+	    [&] { return fill_map(std::pmr::unordered_map<int, int>(&arena_resource)); }, release_arena);
+	run("unordered_map", "tiltyard allocator", [&] { return fill_map(ArenaMap(ArenaMap::allocator_type(allocator))); },
+	    release_arena);
+
+	return 0;
+}
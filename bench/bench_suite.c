@@ -0,0 +1,335 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../include/tiltyard_API.h"
+#include "../include/tiltyard_Thread.h"
+
+/* Measures tiltyard against glibc malloc on the usual arena workloads.
+ *
+ * Every workload runs once with tiltyard and once with malloc (or memset
+ * for the ones that only zero memory), and prints a CSV row per run with
+ * the nanoseconds per operation, the operations and megabytes per second,
+ * and the resident memory of the process when the run ends, so the output
+ * can be kept and compared between releases.
+ *
+ * Workloads:
+ * - alloc_mixed: allocations of mixed sizes and alignments, freed in batches.
+ * - calloc: zeroed allocations of mixed sizes, freed in batches.
+ * - reset_to: a marker is taken, a batch is allocated and the arena goes back to it.
+ * - wipe / clean: zeroing a whole arena, and the middle half of it, at several sizes.
+ * - threads: every thread allocates mixed sizes from its own arena.
+ *
+ * Usage: bench_suite [scale] [max_threads]
+ */
+
+#define BATCH 4096
+#define SIZE_TABLE 1024
+
+static double scale = 1.0;
+static size_t sizes[SIZE_TABLE];
+static size_t alignments[SIZE_TABLE];
+static void *ptrs[BATCH];
+static volatile size_t sink;
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Returns the resident memory of the process in kilobytes. */
+static size_t rss_kb(void)
+{
+	FILE *statm = fopen("/proc/self/statm", "r");
+	unsigned long size = 0, resident = 0;
+
+	if (!statm) return 0;
+	if (fscanf(statm, "%lu %lu", &size, &resident) != 2) resident = 0;
+	fclose(statm);
+	return (size_t)resident * (size_t)sysconf(_SC_PAGESIZE) / 1024;
+}
+
+static size_t scaled(size_t count)
+{
+	size_t result = (size_t)((double)count * scale);
+
+	return result < BATCH ? BATCH : result / BATCH * BATCH;
+}
+
+/* Prints a row of results, 'bytes' is the memory the run went through. */
+static void report(const char *workload, const char *allocator, size_t param, size_t ops, size_t bytes, double elapsed)
+{
+	printf("%s,%s,%zu,%zu,%.3f,%.0f,%.1f,%zu\n", workload, allocator, param, ops,
+	       elapsed * 1e9 / (double)ops, (double)ops / elapsed, (double)bytes / elapsed / (1024.0 * 1024.0), rss_kb());
+	fflush(stdout);
+}
+
+/* Fills the size and alignment tables with a fixed pseudo-random sequence,
+ * sizes between 8 and 512 bytes and alignments of 8, 16 or 64 bytes.
+ */
+static void fill_tables(void)
+{
+	uint32_t state = 2463534242u;
+
+	for (size_t i = 0; i < SIZE_TABLE; i++) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		sizes[i] = 8 + (state % 505);
+		alignments[i] = (state >> 16) % 8 == 0 ? 64 : ((state >> 16) % 2 ? 16 : 8);
+	}
+}
+
+static void bench_alloc_mixed(size_t ops)
+{
+	Arena *arena = tiltyard_create(BATCH * 1024);
+	size_t bytes = 0, sum = 0;
+
+	double start = now();
+	for (size_t i = 0; i < ops; i++) {
+		if (i % BATCH == 0) tiltyard_reset(arena);
+		uint8_t *ptr = tiltyard_alloc_aligned(arena, sizes[i % SIZE_TABLE], alignments[i % SIZE_TABLE]);
+		ptr[0] = (uint8_t)i;
+		sum += ptr[0];
+		bytes += sizes[i % SIZE_TABLE];
+	}
+	report("alloc_mixed", "tiltyard", 0, ops, bytes, now() - start);
+	tiltyard_destroy(arena);
+
+	start = now();
+	for (size_t i = 0; i < ops; i += BATCH) {
+		for (size_t j = 0; j < BATCH; j++) {
+			void *ptr = NULL;
+			if (posix_memalign(&ptr, alignments[(i + j) % SIZE_TABLE], sizes[(i + j) % SIZE_TABLE]) != 0)
+				exit(1);
+			((uint8_t *)ptr)[0] = (uint8_t)j;
+			sum += ((uint8_t *)ptr)[0];
+			ptrs[j] = ptr;
+		}
+		for (size_t j = 0; j < BATCH; j++)
+			free(ptrs[j]);
+	}
+	report("alloc_mixed", "malloc", 0, ops, bytes, now() - start);
+	sink = sum;
+}
+
+static void bench_calloc(size_t ops)
+{
+	Arena *arena = tiltyard_create(BATCH * 1024);
+	size_t bytes = 0, sum = 0;
+
+	double start = now();
+	for (size_t i = 0; i < ops; i++) {
+		if (i % BATCH == 0) tiltyard_reset(arena);
+		uint8_t *ptr = tiltyard_calloc(arena, sizes[i % SIZE_TABLE]);
+		ptr[0] = (uint8_t)i;
+		sum += ptr[1];
+		bytes += sizes[i % SIZE_TABLE];
+	}
+	report("calloc", "tiltyard", 0, ops, bytes, now() - start);
+	tiltyard_destroy(arena);
+
+	start = now();
+	for (size_t i = 0; i < ops; i += BATCH) {
+		for (size_t j = 0; j < BATCH; j++) {
+			uint8_t *ptr = calloc(1, sizes[(i + j) % SIZE_TABLE]);
+			if (!ptr) exit(1);
+			ptr[0] = (uint8_t)j;
+			sum += ptr[1];
+			ptrs[j] = ptr;
+		}
+		for (size_t j = 0; j < BATCH; j++)
+			free(ptrs[j]);
+	}
+	report("calloc", "malloc", 0, ops, bytes, now() - start);
+	sink = sum;
+}
+
+/* Every cycle takes a marker, allocates 'batch' objects and goes back to the marker. */
+static void bench_reset_to(size_t ops, size_t batch)
+{
+	Arena *arena = tiltyard_create(BATCH * 1024);
+	size_t sum = 0;
+
+	tiltyard_alloc(arena, 4096);
+
+	double start = now();
+	for (size_t i = 0; i < ops; i += batch) {
+		size_t marker = tiltyard_get_marker(arena);
+		for (size_t j = 0; j < batch; j++) {
+			uint8_t *ptr = tiltyard_alloc(arena, sizes[j % SIZE_TABLE]);
+			ptr[0] = (uint8_t)j;
+			sum += ptr[0];
+		}
+		tiltyard_reset_to(arena, marker);
+	}
+	report("reset_to", "tiltyard", batch, ops, 0, now() - start);
+	tiltyard_destroy(arena);
+
+	start = now();
+	for (size_t i = 0; i < ops; i += batch) {
+		for (size_t j = 0; j < batch; j++) {
+			uint8_t *ptr = malloc(sizes[j % SIZE_TABLE]);
+			if (!ptr) exit(1);
+			ptr[0] = (uint8_t)j;
+			sum += ptr[0];
+			ptrs[j] = ptr;
+		}
+		for (size_t j = 0; j < batch; j++)
+			free(ptrs[j]);
+	}
+	report("reset_to", "malloc", batch, ops, 0, now() - start);
+	sink = sum;
+}
+
+/* Zeroes 'size' bytes 'rounds' times, with the memory written before every
+ * round outside of the timed part, so every round zeroes dirty memory.
+ */
+static void bench_zero(size_t size, size_t rounds)
+{
+	Arena *arena = tiltyard_create(size);
+	uint8_t *memory = tiltyard_alloc(arena, size);
+	double elapsed = 0.0;
+
+	for (size_t i = 0; i < rounds; i++) {
+		memset(memory, (int)i + 1, size);
+		double start = now();
+		tiltyard_wipe(arena);
+		elapsed += now() - start;
+	}
+	report("wipe", "tiltyard", size, rounds, size * rounds, elapsed);
+
+	elapsed = 0.0;
+	for (size_t i = 0; i < rounds; i++) {
+		memset(memory, (int)i + 1, size);
+		double start = now();
+		tiltyard_clean_from_until(arena, size / 4, size / 4 * 3);
+		elapsed += now() - start;
+	}
+	report("clean", "tiltyard", size, rounds, size / 2 * rounds, elapsed);
+	sink = memory[size / 2];
+	tiltyard_destroy(arena);
+
+	memory = malloc(size);
+	if (!memory) exit(1);
+
+	elapsed = 0.0;
+	for (size_t i = 0; i < rounds; i++) {
+		memset(memory, (int)i + 1, size);
+		double start = now();
+		memset(memory, 0, size);
+		__asm__ volatile("" : : "r"(memory) : "memory");
+		elapsed += now() - start;
+	}
+	report("wipe", "memset", size, rounds, size * rounds, elapsed);
+
+	elapsed = 0.0;
+	for (size_t i = 0; i < rounds; i++) {
+		memset(memory, (int)i + 1, size);
+		double start = now();
+		memset(memory + size / 4, 0, size / 2);
+		__asm__ volatile("" : : "r"(memory) : "memory");
+		elapsed += now() - start;
+	}
+	report("clean", "memset", size, rounds, size / 2 * rounds, elapsed);
+	sink = memory[size / 2];
+	free(memory);
+}
+
+static size_t thread_ops;
+static bool thread_use_malloc;
+
+static void *thread_worker(void *arg)
+{
+	size_t *result = arg;
+	size_t sum = 0;
+	void **batch = malloc(BATCH * sizeof(void *));
+	if (!batch) exit(1);
+
+	if (thread_use_malloc) {
+		for (size_t i = 0; i < thread_ops; i += BATCH) {
+			for (size_t j = 0; j < BATCH; j++) {
+				uint8_t *ptr = malloc(sizes[(i + j) % SIZE_TABLE]);
+				if (!ptr) exit(1);
+				ptr[0] = (uint8_t)j;
+				sum += ptr[0];
+				batch[j] = ptr;
+			}
+			for (size_t j = 0; j < BATCH; j++)
+				free(batch[j]);
+		}
+	} else {
+		Arena *arena = tiltyard_thread_arena();
+		for (size_t i = 0; i < thread_ops; i++) {
+			if (i % BATCH == 0) tiltyard_reset(arena);
+			uint8_t *ptr = tiltyard_alloc(arena, sizes[i % SIZE_TABLE]);
+			ptr[0] = (uint8_t)i;
+			sum += ptr[0];
+		}
+		tiltyard_thread_arena_release();
+	}
+
+	free(batch);
+	*result = sum;
+	return NULL;
+}
+
+static void bench_threads(size_t threads, size_t ops, bool use_malloc)
+{
+	pthread_t *ids = malloc(threads * sizeof(pthread_t));
+	size_t *results = malloc(threads * 64);
+	if (!ids || !results) exit(1);
+
+	thread_ops = ops;
+	thread_use_malloc = use_malloc;
+
+	double start = now();
+	for (size_t i = 0; i < threads; i++)
+		pthread_create(&ids[i], NULL, thread_worker, &results[i * 8]);
+	for (size_t i = 0; i < threads; i++)
+		pthread_join(ids[i], NULL);
+	report("threads", use_malloc ? "malloc" : "tiltyard", threads, threads * ops, 0, now() - start);
+
+	free(ids);
+	free(results);
+}
+
+int main(int argc, char **argv)
+{
+	size_t max_threads = (size_t)sysconf(_SC_NPROCESSORS_ONLN);
+
+	if (argc > 1) scale = strtod(argv[1], NULL);
+	if (argc > 2) max_threads = strtoul(argv[2], NULL, 10);
+	if (scale <= 0.0) scale = 1.0;
+	if (max_threads == 0) max_threads = 1;
+
+	fill_tables();
+	printf("workload,allocator,param,ops,ns_per_op,ops_per_sec,mb_per_sec,rss_kb\n");
+
+	bench_alloc_mixed(scaled(20 * 1000 * 1000));
+	bench_calloc(scaled(10 * 1000 * 1000));
+	bench_reset_to(scaled(20 * 1000 * 1000), 16);
+	bench_reset_to(scaled(20 * 1000 * 1000), 1024);
+
+	for (size_t size = 64 * 1024; size <= (size_t)256 * 1024 * 1024; size *= 16) {
+		size_t rounds = (size_t)((double)((size_t)1 << 30) / (double)size * scale);
+		bench_zero(size, rounds < 4 ? 4 : rounds);
+	}
+
+	for (size_t threads = 1; ; ) {
+		bench_threads(threads, scaled(10 * 1000 * 1000), false);
+		bench_threads(threads, scaled(10 * 1000 * 1000), true);
+		if (threads == max_threads) break;
+		threads = threads * 2 > max_threads ? max_threads : threads * 2;
+	}
+
+	tiltyard_block_pool_drain(tiltyard_global_block_pool());
+	return 0;
+}
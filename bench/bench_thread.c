@@ -0,0 +1,93 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../include/tiltyard_API.h"
+#include "../include/tiltyard_Thread.h"
+
+/* Measures how allocating from thread arenas scales with the amount of threads.
+ *
+ * Every thread allocates objects of mixed sizes from its own arena,
+ * resetting it every RESET_EVERY allocations, and the throughput
+ * of every amount of threads is compared with the one of a single thread.
+ *
+ * Usage: bench_thread [max_threads] [allocs_per_thread]
+ */
+
+#define RESET_EVERY 4096
+
+static size_t allocs_per_thread = 10 * 1000 * 1000;
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void *worker(void *arg)
+{
+	size_t *sink = arg;
+	Arena *arena = tiltyard_thread_arena();
+	size_t sum = 0;
+
+	for (size_t i = 0; i < allocs_per_thread; i++) {
+		if (i % RESET_EVERY == 0)
+			tiltyard_reset(arena);
+
+		uint8_t *ptr = tiltyard_alloc(arena, 16 + (i & 7) * 32);
+		ptr[0] = (uint8_t)i;
+		sum += ptr[0];
+	}
+
+	*sink = sum;
+	tiltyard_thread_arena_release();
+	return NULL;
+}
+
+static double run(size_t threads)
+{
+	pthread_t *ids = malloc(threads * sizeof(pthread_t));
+	size_t *sinks = malloc(threads * 64);
+	if (!ids || !sinks) {
+		fprintf(stderr, "bench_thread: out of memory\n");
+		exit(1);
+	}
+
+	double start = now();
+	for (size_t i = 0; i < threads; i++)
+		pthread_create(&ids[i], NULL, worker, &sinks[i * 8]);
+	for (size_t i = 0; i < threads; i++)
+		pthread_join(ids[i], NULL);
+	double elapsed = now() - start;
+
+	free(ids);
+	free(sinks);
+	return (double)(threads * allocs_per_thread) / elapsed;
+}
+
+int main(int argc, char **argv)
+{
+	size_t max_threads = (size_t)sysconf(_SC_NPROCESSORS_ONLN);
+
+	if (argc > 1) max_threads = strtoul(argv[1], NULL, 10);
+	if (argc > 2) allocs_per_thread = strtoul(argv[2], NULL, 10);
+	if (max_threads == 0) max_threads = 1;
+
+	double single = 0.0;
+	printf("%8s %16s %12s\n", "threads", "allocs/s", "efficiency");
+	for (size_t threads = 1; threads <= max_threads; ) {
+		double rate = run(threads);
+		if (threads == 1) single = rate;
+
+		printf("%8zu %16.0f %11.1f%%\n", threads, rate, 100.0 * rate / (single * (double)threads));
+		if (threads == max_threads) break;
+		threads = threads * 2 > max_threads ? max_threads : threads * 2;
+	}
+
+	tiltyard_block_pool_drain(tiltyard_global_block_pool());
+	return 0;
+}
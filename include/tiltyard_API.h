@@ -1,16 +1,161 @@
 #pragma once
 
+#include <stdbool.h>
 #include <sys/types.h>
 #include <stdint.h>
 
-typedef struct {
+/* Build with -DTILTYARD_STATS=0 to stop tracking alloc_count
+ * and high_water on every allocation. The library and the
+ * code using it must be built with the same value.
+ */
+#ifndef TILTYARD_STATS
+#define TILTYARD_STATS 1
+#endif
+
+#define TILTYARD_UNLIKELY(x) __builtin_expect(!!(x), 0)
+
+/* Evaluates to 'alignment', and fails to compile if 'alignment'
+ * is a constant that is not a power of two.
+ */
+#define TILTYARD_CONST_ALIGNMENT(alignment) \
+	((alignment) + 0 * sizeof(char[((alignment) != 0 && ((alignment) & ((alignment) - 1)) == 0) ? 1 : -1]))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum tiltyard_arena_kind {
+	TILTYARD_FIXED_ARENA,
+	TILTYARD_GROWABLE_ARENA,
+	TILTYARD_VIRTUAL_ARENA,
+};
+
+/* Options of 'tiltyard_create_with_options', combined with '|'. */
+enum tiltyard_create_option {
+	TILTYARD_CREATE_PREFAULT = 1 << 0,
+	TILTYARD_CREATE_HUGE_PAGES = 1 << 1,
+};
+
+/* Size of the transparent huge pages asked by TILTYARD_CREATE_HUGE_PAGES. */
+#define TILTYARD_HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)
+
+enum tiltyard_decommit_mode {
+	TILTYARD_DECOMMIT_NEVER,
+	TILTYARD_DECOMMIT_DONTNEED,
+	TILTYARD_DECOMMIT_FREE,
+};
+
+/* Header of a block of a growable arena, its memory follows the header. */
+typedef struct TiltyardBlock {
+	struct TiltyardBlock *prev;
+	size_t start;
+	size_t capacity;
+} TiltyardBlock;
+
+/* What an arena does when an allocation does not fit, see tiltyard_set_overflow. */
+enum tiltyard_overflow_policy {
+	TILTYARD_OVERFLOW_ABORT,
+	TILTYARD_OVERFLOW_NULL,
+	TILTYARD_OVERFLOW_FALLBACK,
+	TILTYARD_OVERFLOW_HEAP,
+	TILTYARD_OVERFLOW_GROW,
+	TILTYARD_OVERFLOW_CALLBACK,
+};
+
+struct Arena;
+
+/* Supplies 'size' bytes aligned to 'alignment' that did not fit in 'arena', or NULL. */
+typedef void *(*TiltyardOverflowCallback)(struct Arena *arena, size_t size, size_t alignment, void *user);
+
+/* Smallest threshold of the allocations given their own mapping. */
+#define TILTYARD_LARGE_THRESHOLD_MIN ((size_t)4096)
+
+/* Header of an allocation given its own mapping, see tiltyard_set_large_threshold,
+ * or spilled to the heap, see tiltyard_set_overflow. It sits at the start of the
+ * mapping (or of the heap block) and the memory handed out follows it.
+ */
+typedef struct TiltyardLargeAlloc {
+	struct TiltyardLargeAlloc *prev;
+	uint8_t *data;
+	size_t mapped_size;
+	size_t marker;
+	bool heap;
+} TiltyardLargeAlloc;
+
+/* Header of the file of a file arena, see tiltyard_File.h */
+struct TiltyardFileHeader;
+
+/* Cache of blocks shared by several arenas, see tiltyard_Thread.h */
+typedef struct TiltyardBlockPool TiltyardBlockPool;
+
+typedef struct Arena {
 	uint8_t *base;
 	size_t capacity;
 	size_t offset;
+	size_t limit;
 
 	size_t last_alloc_offset;
 	size_t high_water;
 	size_t alloc_count;
+
+	enum tiltyard_arena_kind kind;
+
+	TiltyardBlock *block;
+	TiltyardBlock *block_cache;
+	TiltyardBlockPool *block_pool;
+	size_t block_start;
+	size_t max_capacity;
+	size_t block_count;
+	size_t cached_block_count;
+
+	size_t commit_granule;
+	size_t commit_peak;
+
+	enum tiltyard_decommit_mode decommit_mode;
+	size_t decommit_slack;
+	size_t decommit_peak;
+	size_t decommitted;
+	size_t refaulted;
+
+	size_t dirty_high_water;
+
+	size_t clean_threads;
+	bool clean_drop_pages;
+
+	size_t mapped_size;
+	unsigned create_options;
+	bool huge_pages;
+
+	struct Arena *parent;
+	size_t parent_marker;
+	size_t parent_end;
+	bool owns_base;
+	bool owns_header;
+	bool borrowed;
+
+	size_t open_temps;
+
+	size_t top;
+	size_t top_dirty;
+	size_t top_high_water;
+	size_t top_alloc_count;
+
+	size_t large_threshold;
+	TiltyardLargeAlloc *large_allocs;
+	size_t large_count;
+	size_t large_bytes;
+
+	enum tiltyard_overflow_policy overflow_policy;
+	struct Arena *overflow_fallback;
+	TiltyardOverflowCallback overflow_callback;
+	void *overflow_user;
+	size_t overflow_count;
+
+	struct TiltyardFileHeader *file_header;
+	int file_fd;
+	uint64_t file_root;
+
+	bool snapshot_open;
 } Arena;
 
 typedef struct {
@@ -20,9 +165,30 @@ typedef struct {
 	size_t high_water;
 	size_t alloc_count;
 	size_t last_alloc_offset;
+	size_t block_count;
+	size_t cached_block_count;
+	size_t committed;
+	size_t decommitted;
+	size_t refaulted;
+	size_t dirty_high_water;
+	bool huge_pages;
+	size_t open_temps;
+	size_t top_used;
+	size_t top_high_water;
+	size_t top_alloc_count;
+	size_t large_count;
+	size_t large_bytes;
+	size_t overflow_count;
 } TiltyardStats;
 
 Arena *tiltyard_create(size_t capacity);
+Arena *tiltyard_create_growable(size_t block_capacity, size_t max_capacity);
+Arena *tiltyard_create_virtual(size_t reserve, size_t commit_granule);
+Arena *tiltyard_create_pooled(TiltyardBlockPool *pool, size_t block_capacity, size_t max_capacity);
+Arena *tiltyard_create_with_options(size_t capacity, unsigned options);
+Arena *tiltyard_init_buffer(Arena *arena, void *buffer, size_t capacity);
+Arena *tiltyard_create_in_buffer(void *buffer, size_t size);
+Arena *tiltyard_create_sub(Arena *parent, size_t capacity);
 
 void *tiltyard_alloc(Arena *arena, size_t size);
 void *tiltyard_calloc(Arena *arena, size_t size);
@@ -30,6 +196,19 @@ void *tiltyard_calloc(Arena *arena, size_t size);
 void *tiltyard_alloc_aligned(Arena *arena, size_t size, size_t alignment);
 void *tiltyard_calloc_aligned(Arena *arena, size_t size, size_t alignment);
 
+void *tiltyard_try_alloc(Arena *arena, size_t size);
+void *tiltyard_try_calloc(Arena *arena, size_t size);
+void *tiltyard_try_alloc_aligned(Arena *arena, size_t size, size_t alignment);
+void *tiltyard_try_calloc_aligned(Arena *arena, size_t size, size_t alignment);
+
+void *tiltyard_realloc(Arena *arena, void *ptr, size_t old_size, size_t new_size);
+void *tiltyard_realloc_aligned(Arena *arena, void *ptr, size_t old_size, size_t new_size, size_t alignment);
+void tiltyard_free_last(Arena *arena);
+
+void *tiltyard_alloc_top(Arena *arena, size_t size);
+void *tiltyard_alloc_top_aligned(Arena *arena, size_t size, size_t alignment);
+void *tiltyard_calloc_top(Arena *arena, size_t size);
+
 void tiltyard_destroy(Arena *arena);
 void tiltyard_wipe(Arena *arena);
 void tiltyard_null(Arena **arena);
@@ -38,10 +217,20 @@ void tiltyard_destroy_and_null(Arena **arena);
 void tiltyard_wipe_destroy_and_null(Arena **arena);
 
 void tiltyard_reset(Arena *arena);
+void tiltyard_set_decommit(Arena *arena, enum tiltyard_decommit_mode mode, size_t retained_slack);
+void tiltyard_set_clean(Arena *arena, size_t threads, bool drop_pages);
+void tiltyard_set_large_threshold(Arena *arena, size_t threshold);
+void tiltyard_set_overflow(Arena *arena, enum tiltyard_overflow_policy policy);
+void tiltyard_set_overflow_fallback(Arena *arena, Arena *fallback);
+void tiltyard_set_overflow_callback(Arena *arena, TiltyardOverflowCallback callback, void *user);
 
 size_t tiltyard_get_marker(Arena *arena);
 void tiltyard_reset_to(Arena *arena, size_t marker);
 
+size_t tiltyard_get_top_marker(Arena *arena);
+void tiltyard_reset_top(Arena *arena);
+void tiltyard_reset_top_to(Arena *arena, size_t marker);
+
 void tiltyard_clean_until(Arena *arena, size_t marker);
 void tiltyard_clean_from(Arena *arena, size_t marker);
 void tiltyard_clean_from_until(Arena *arena, size_t marker_beg, size_t marker_end);
@@ -52,4 +241,81 @@ size_t tiltyard_get_available_capacity(Arena *arena);
 size_t tiltyard_get_high_water(Arena *arena);
 size_t tiltyard_get_alloc_count(Arena *arena);
 size_t tiltyard_get_last_alloc(Arena *arena);
+size_t tiltyard_get_block_count(Arena *arena);
+size_t tiltyard_get_cached_block_count(Arena *arena);
+size_t tiltyard_get_committed(Arena *arena);
+size_t tiltyard_get_decommitted(Arena *arena);
+size_t tiltyard_get_refaulted(Arena *arena);
+size_t tiltyard_get_dirty_high_water(Arena *arena);
+size_t tiltyard_get_huge_pages(Arena *arena);
+bool tiltyard_get_huge_pages_obtained(Arena *arena);
+size_t tiltyard_get_open_temps(Arena *arena);
+size_t tiltyard_get_top_used(Arena *arena);
+size_t tiltyard_get_top_high_water(Arena *arena);
+size_t tiltyard_get_top_alloc_count(Arena *arena);
+size_t tiltyard_get_large_count(Arena *arena);
+size_t tiltyard_get_large_bytes(Arena *arena);
+size_t tiltyard_get_overflow_count(Arena *arena);
 TiltyardStats tiltyard_get_stats(Arena *arena);
+
+void *tiltyard_alloc_slow(Arena *arena, size_t size, size_t alignment);
+
+/* Allocate 'size' bytes aligned to 'alignment' without leaving the caller.
+ *
+ * Same behavior as 'tiltyard_alloc_aligned' except:
+ * - 'arena' must not be NULL and 'alignment' must be a power of two,
+ *   they are not checked.
+ * - Only the allocations that do not fit below the arena's limit
+ *   call a function, 'tiltyard_alloc_slow', which does the checks,
+ *   grows the arena and applies its overflow policy.
+ * - Allocations above the arena's large threshold only get their own
+ *   mapping when they do not fit, see 'tiltyard_set_large_threshold'.
+ *
+ * Notes:
+ * - With a constant 'alignment' the fast path is an add, a mask
+ *   and the compares against the arena's limit.
+ */
+static inline __attribute__((always_inline)) void *tiltyard_alloc_inline(Arena *arena, size_t size, size_t alignment)
+{
+	size_t offset = arena->offset;
+	uintptr_t cursor = (uintptr_t)arena->base + (offset - arena->block_start);
+	size_t padding = (size_t)(((cursor + alignment - 1) & ~(uintptr_t)(alignment - 1)) - cursor);
+	size_t available = arena->limit - offset;
+
+	if (TILTYARD_UNLIKELY(size > available || padding > available - size))
+		return tiltyard_alloc_slow(arena, size, alignment);
+
+	arena->offset = offset + padding + size;
+	arena->last_alloc_offset = offset;
+#if TILTYARD_STATS
+	arena->alloc_count++;
+	if (arena->offset > arena->high_water)
+		arena->high_water = arena->offset;
+#endif
+	return (void *)(cursor + padding);
+}
+
+/* Allocate an object of type 'type', aligned to 'alignment',
+ * an array of 'count' of them, or 'size' bytes aligned to
+ * the constant 'alignment', through the inlined fast path.
+ */
+#ifdef __cplusplus
+#define TILTYARD_ALIGNOF(type) alignof(type)
+#else
+#define TILTYARD_ALIGNOF(type) _Alignof(type)
+#endif
+
+#define TILTYARD_NEW(arena, type) \
+	((type *)tiltyard_alloc_inline((arena), sizeof(type), TILTYARD_ALIGNOF(type)))
+
+#define TILTYARD_NEW_ARRAY(arena, type, count) \
+	((type *)tiltyard_alloc_inline((arena), \
+		(size_t)(count) > SIZE_MAX / sizeof(type) ? SIZE_MAX : (size_t)(count) * sizeof(type), \
+		TILTYARD_ALIGNOF(type)))
+
+#define TILTYARD_ALLOC_CONST(arena, size, alignment) \
+	tiltyard_alloc_inline((arena), (size), TILTYARD_CONST_ALIGNMENT(alignment))
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Ranges of at least this size are zeroed with non-temporal stores,
+ * which go straight to memory instead of filling the cache.
+ */
+#define TILTYARD_CLEAN_STREAM_MIN ((size_t)4 * 1024 * 1024)
+
+/* Smallest part of a range given to each worker thread. */
+#define TILTYARD_CLEAN_PARALLEL_MIN ((size_t)64 * 1024 * 1024)
+
+/* Smallest amount of whole pages that are dropped instead of written. */
+#define TILTYARD_CLEAN_DROP_MIN ((size_t)2 * 1024 * 1024)
+
+void tiltyard_bulk_zero(void *dst, size_t size, size_t threads, bool drop_pages);
+
+#ifdef __cplusplus
+}
+#endif
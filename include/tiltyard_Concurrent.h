@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "tiltyard_API.h"
+
+#define TILTYARD_CONCURRENT_SHARDS 16
+#define TILTYARD_CONCURRENT_GRANULE 16
+
+/* Allocation counter of a group of threads, alone in its cache line. */
+typedef struct {
+	_Alignas(64) atomic_size_t alloc_count;
+} TiltyardCounterShard;
+
+/* Arena many threads can allocate from at the same time. */
+typedef struct {
+	uint8_t *base;
+	size_t capacity;
+	size_t high_water;
+	size_t epoch;
+
+	_Alignas(64) atomic_size_t offset;
+
+	TiltyardCounterShard shards[TILTYARD_CONCURRENT_SHARDS];
+} TiltyardConcurrentArena;
+
+TiltyardConcurrentArena *tiltyard_concurrent_create(size_t capacity);
+
+void *tiltyard_concurrent_alloc(TiltyardConcurrentArena *arena, size_t size);
+void *tiltyard_concurrent_alloc_aligned(TiltyardConcurrentArena *arena, size_t size, size_t alignment);
+
+void tiltyard_concurrent_reset(TiltyardConcurrentArena *arena);
+void tiltyard_concurrent_destroy(TiltyardConcurrentArena *arena);
+
+TiltyardStats tiltyard_concurrent_get_stats(TiltyardConcurrentArena *arena);
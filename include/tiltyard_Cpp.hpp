@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
+
+#include "tiltyard_API.h"
+#include "tiltyard_Scratch.h"
+
+namespace tiltyard {
+
+/* Destroys an arena owned by an ArenaPtr. */
+struct ArenaDeleter {
+	void operator()(Arena *arena) const noexcept { tiltyard_destroy(arena); }
+};
+
+/* Owns an arena, destroying it when it goes out of scope. */
+using ArenaPtr = std::unique_ptr<Arena, ArenaDeleter>;
+
+inline ArenaPtr make_arena(std::size_t capacity)
+{
+	return ArenaPtr(tiltyard_create(capacity));
+}
+
+inline ArenaPtr make_growable_arena(std::size_t block_capacity, std::size_t max_capacity)
+{
+	return ArenaPtr(tiltyard_create_growable(block_capacity, max_capacity));
+}
+
+inline ArenaPtr make_virtual_arena(std::size_t reserve, std::size_t commit_granule = 0)
+{
+	return ArenaPtr(tiltyard_create_virtual(reserve, commit_granule));
+}
+
+namespace detail {
+
+/* Allocates 'bytes' bytes aligned to 'alignment', throwing std::bad_alloc
+ * instead of aborting or returning NULL when the arena is full.
+ */
+inline void *allocate(Arena *arena, std::size_t bytes, std::size_t alignment)
+{
+	void *ptr = tiltyard_try_alloc_aligned(arena, bytes, alignment);
+	if (!ptr) throw std::bad_alloc();
+	return ptr;
+}
+
+/* Gives the 'bytes' bytes at 'ptr' back to the arena when they are its last
+ * allocation, every other deallocation is a no-op until the arena is reset.
+ */
+inline void deallocate(Arena *arena, void *ptr, std::size_t bytes, std::size_t alignment) noexcept
+{
+	tiltyard_realloc_aligned(arena, ptr, bytes, 0, alignment);
+}
+
+} /* namespace detail */
+
+/* std::pmr::memory_resource allocating from an arena.
+ *
+ * Same semantics as std::pmr::monotonic_buffer_resource: memory is only
+ * released when the arena is reset or destroyed, except for the last
+ * allocation, which is given back to the arena right away, so a container
+ * that frees what it just allocated does not leave it behind.
+ *
+ * The resource does not own the arena, and release() only frees what was
+ * allocated in the arena since the resource was constructed.
+ */
+class MemoryResource : public std::pmr::memory_resource {
+public:
+	explicit MemoryResource(Arena *arena) noexcept
+		: arena_(arena), marker_(tiltyard_get_marker(arena)) {}
+
+	Arena *arena() const noexcept { return arena_; }
+
+	/* Frees every allocation made in the arena since the resource was constructed. */
+	void release() noexcept { tiltyard_reset_to(arena_, marker_); }
+
+private:
+	void *do_allocate(std::size_t bytes, std::size_t alignment) override
+	{
+		return detail::allocate(arena_, bytes, alignment);
+	}
+
+	void do_deallocate(void *ptr, std::size_t bytes, std::size_t alignment) override
+	{
+		detail::deallocate(arena_, ptr, bytes, alignment);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+	{
+		const MemoryResource *resource = dynamic_cast<const MemoryResource *>(&other);
+		return resource && resource->arena_ == arena_;
+	}
+
+	Arena *arena_;
+	std::size_t marker_;
+};
+
+/* Stateful STL allocator allocating from an arena.
+ *
+ * Same semantics as MemoryResource, without the virtual calls, for the
+ * containers whose allocator is a template parameter.
+ */
+template <class T>
+class Allocator {
+public:
+	using value_type = T;
+	using propagate_on_container_copy_assignment = std::true_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+	using is_always_equal = std::false_type;
+
+	explicit Allocator(Arena *arena) noexcept : arena_(arena) {}
+
+	template <class U>
+	Allocator(const Allocator<U> &other) noexcept : arena_(other.arena()) {}
+
+	Arena *arena() const noexcept { return arena_; }
+
+	T *allocate(std::size_t count)
+	{
+		if (count > std::numeric_limits<std::size_t>::max() / sizeof(T))
+			throw std::bad_array_new_length();
+
+		return static_cast<T *>(detail::allocate(arena_, count * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T *ptr, std::size_t count) noexcept
+	{
+		detail::deallocate(arena_, ptr, count * sizeof(T), alignof(T));
+	}
+
+	template <class U>
+	bool operator==(const Allocator<U> &other) const noexcept { return arena_ == other.arena(); }
+
+	template <class U>
+	bool operator!=(const Allocator<U> &other) const noexcept { return arena_ != other.arena(); }
+
+private:
+	Arena *arena_;
+};
+
+} /* namespace tiltyard */
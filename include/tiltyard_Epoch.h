@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "tiltyard_API.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Returned by 'tiltyard_epoch_pin' when no epoch was finished yet. */
+#define TILTYARD_EPOCH_NONE SIZE_MAX
+
+/* One arena of an epoch arena set, with the epoch it holds and the
+ * amount of readers pinning it, alone in its cache line.
+ */
+typedef struct {
+	_Alignas(64) Arena *arena;
+	_Atomic(void *) root;
+	atomic_size_t epoch;
+	atomic_size_t readers;
+} TiltyardEpochSlot;
+
+/* Set of arenas rotated by epochs: the epoch 'epoch' is built in the arena
+ * of the slot 'epoch % count' while the epochs before it are read.
+ */
+typedef struct {
+	TiltyardEpochSlot *slots;
+	size_t count;
+
+	_Alignas(64) atomic_size_t epoch;
+} TiltyardEpochSet;
+
+TiltyardEpochSet *tiltyard_epoch_create(size_t count, size_t capacity);
+
+Arena *tiltyard_epoch_current(TiltyardEpochSet *set);
+bool tiltyard_epoch_advance(TiltyardEpochSet *set);
+
+size_t tiltyard_epoch_pin(TiltyardEpochSet *set);
+void tiltyard_epoch_unpin(TiltyardEpochSet *set, size_t epoch);
+
+Arena *tiltyard_epoch_get_arena(TiltyardEpochSet *set, size_t epoch);
+void tiltyard_epoch_set_root(TiltyardEpochSet *set, void *root);
+void *tiltyard_epoch_get_root(TiltyardEpochSet *set, size_t epoch);
+size_t tiltyard_epoch_get_epoch(TiltyardEpochSet *set);
+
+void tiltyard_epoch_destroy(TiltyardEpochSet *set);
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,8 +2,8 @@
 
 #include <stdbool.h>
 
-#define TILTYARD_ERROR_CODE_AMOUNT 8
-#define TILTYARD_FUNC_AMOUNT 23
+#define TILTYARD_ERROR_CODE_AMOUNT 22
+#define TILTYARD_FUNC_AMOUNT 129
 
 #define TILTYARD_ERROR_HANDLING_FUNC_AMOUNT 2
 #define TILTYARD_ERROR_HANDLING_CODE_AMOUNT 1
@@ -17,6 +17,20 @@ enum tiltyard_error_code {
 	INVALID_ALIGNMENT,
 	ALIGNMENT_TOO_BIG,
 	OUT_OF_BOUNDS_MARKER,
+	INVALID_MAX_CAPACITY,
+	VIRTUAL_MEMORY_RESERVE_FAILED,
+	VIRTUAL_MEMORY_COMMIT_FAILED,
+	UNSUPPORTED_ARENA_KIND,
+	INVALID_FORMAT,
+	SCRATCH_ARENAS_CONFLICT,
+	FILE_MAPPING_FAILED,
+	INVALID_FILE_FORMAT,
+	SNAPSHOT_FAILED,
+	SHARED_MEMORY_FAILED,
+	RING_RELEASE_OUT_OF_ORDER,
+	EPOCH_COUNT_TOO_SMALL,
+	MISSING_OVERFLOW_HANDLER,
+	ARENA_HAS_OPEN_SNAPSHOT,
 
 	TILTYARD_ERROR_HANDLING_ERROR,
 };
@@ -45,10 +59,117 @@ enum tiltyard_func {
 	TILTYARD_GET_ALLOC_COUNT,
 	TILTYARD_GET_LAST_ALLOC,
 	TILTYARD_GET_STATS,
+	TILTYARD_CREATE_GROWABLE,
+	TILTYARD_GET_BLOCK_COUNT,
+	TILTYARD_GET_CACHED_BLOCK_COUNT,
+	TILTYARD_CREATE_VIRTUAL,
+	TILTYARD_GET_COMMITTED,
+	TILTYARD_SET_DECOMMIT,
+	TILTYARD_GET_DECOMMITTED,
+	TILTYARD_GET_REFAULTED,
+	TILTYARD_CREATE_POOLED,
+	TILTYARD_THREAD_ARENA,
+	TILTYARD_THREAD_ARENA_RELEASE,
+	TILTYARD_CONCURRENT_CREATE,
+	TILTYARD_CONCURRENT_ALLOC,
+	TILTYARD_CONCURRENT_ALLOC_ALIGNED,
+	TILTYARD_CONCURRENT_RESET,
+	TILTYARD_CONCURRENT_DESTROY,
+	TILTYARD_CONCURRENT_GET_STATS,
+	TILTYARD_REALLOC,
+	TILTYARD_REALLOC_ALIGNED,
+	TILTYARD_FREE_LAST,
+	TILTYARD_VECTOR_INIT,
+	TILTYARD_VECTOR_RESERVE,
+	TILTYARD_VECTOR_PUSH_SLOW,
+	TILTYARD_VECTOR_SHRINK,
+	TILTYARD_STRING_INIT,
+	TILTYARD_STRING_APPEND,
+	TILTYARD_STRING_APPENDF,
+	TILTYARD_STRING_FINISH,
+	TILTYARD_POOL_INIT,
+	TILTYARD_POOL_ALLOC_SLOW,
+	TILTYARD_POOL_RESET,
+	TILTYARD_POOL_GET_STATS,
+	TILTYARD_POOL_SET_INIT,
+	TILTYARD_POOL_SET_ALLOC,
+	TILTYARD_POOL_SET_FREE,
+	TILTYARD_POOL_SET_RESET,
+	TILTYARD_GET_DIRTY_HIGH_WATER,
+	TILTYARD_SET_CLEAN,
+	TILTYARD_CREATE_WITH_OPTIONS,
+	TILTYARD_GET_HUGE_PAGES,
+	TILTYARD_INIT_BUFFER,
+	TILTYARD_CREATE_IN_BUFFER,
+	TILTYARD_CREATE_SUB,
+	TILTYARD_TEMP_BEGIN,
+	TILTYARD_TEMP_END,
+	TILTYARD_SCRATCH_BEGIN,
+	TILTYARD_GET_OPEN_TEMPS,
+	TILTYARD_ALLOC_TOP_ALIGNED,
+	TILTYARD_CALLOC_TOP,
+	TILTYARD_GET_TOP_MARKER,
+	TILTYARD_RESET_TOP,
+	TILTYARD_RESET_TOP_TO,
+	TILTYARD_GET_TOP_USED,
+	TILTYARD_GET_TOP_HIGH_WATER,
+	TILTYARD_GET_TOP_ALLOC_COUNT,
+	TILTYARD_MAP_INIT,
+	TILTYARD_MAP_INSERT,
+	TILTYARD_INTERNER_INIT,
+	TILTYARD_INTERN,
+	TILTYARD_SET_LARGE_THRESHOLD,
+	TILTYARD_GET_LARGE_COUNT,
+	TILTYARD_GET_LARGE_BYTES,
+	TILTYARD_SET_OVERFLOW,
+	TILTYARD_SET_OVERFLOW_FALLBACK,
+	TILTYARD_SET_OVERFLOW_CALLBACK,
+	TILTYARD_GET_OVERFLOW_COUNT,
+	TILTYARD_CREATE_FILE,
+	TILTYARD_FILE_CHECKPOINT,
+	TILTYARD_FILE_SET_ROOT,
+	TILTYARD_FILE_GET_ROOT,
+	TILTYARD_SNAPSHOT_BEGIN,
+	TILTYARD_SNAPSHOT_RESTORE,
+	TILTYARD_SNAPSHOT_END,
+	TILTYARD_SNAPSHOT_GET_PAGE_COUNT,
+	TILTYARD_SHARED_CREATE,
+	TILTYARD_SHARED_OPEN,
+	TILTYARD_SHARED_OPEN_FD,
+	TILTYARD_SHARED_ALLOC_ALIGNED,
+	TILTYARD_SHARED_HANDLE,
+	TILTYARD_SHARED_RESOLVE,
+	TILTYARD_SHARED_VALID,
+	TILTYARD_SHARED_SET_ROOT,
+	TILTYARD_SHARED_GET_ROOT,
+	TILTYARD_SHARED_RESET,
+	TILTYARD_SHARED_DESTROY,
+	TILTYARD_SHARED_GET_FD,
+	TILTYARD_SHARED_GET_GENERATION,
+	TILTYARD_SHARED_GET_STATS,
+	TILTYARD_RING_CREATE,
+	TILTYARD_RING_ALLOC,
+	TILTYARD_RING_PUBLISH,
+	TILTYARD_RING_PEEK,
+	TILTYARD_RING_RELEASE,
+	TILTYARD_RING_DESTROY,
+	TILTYARD_RING_GET_STATS,
+	TILTYARD_EPOCH_CREATE,
+	TILTYARD_EPOCH_CURRENT,
+	TILTYARD_EPOCH_ADVANCE,
+	TILTYARD_EPOCH_PIN,
+	TILTYARD_EPOCH_UNPIN,
+	TILTYARD_EPOCH_GET_ARENA,
+	TILTYARD_EPOCH_SET_ROOT,
+	TILTYARD_EPOCH_GET_ROOT,
+	TILTYARD_EPOCH_GET_EPOCH,
+	TILTYARD_EPOCH_DESTROY,
+	TILTYARD_GET_HUGE_PAGES_OBTAINED,
 
 
 	GET_ERROR_CODE_STRING,
 	GET_FUNC_STRING,
 };
 
+__attribute__((cold))
 void tiltyard_handle_error(const enum tiltyard_error_code tiltyard_error_code, const enum tiltyard_func in_func, const bool fatal);
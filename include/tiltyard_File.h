@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "tiltyard_API.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* First bytes of every file holding an arena. */
+#define TILTYARD_FILE_MAGIC "TILTYARD"
+
+/* Version of the layout of TiltyardFileHeader, files of other versions are refused. */
+#define TILTYARD_FILE_VERSION 1
+
+/* Header at the beginning of a file holding an arena, its memory follows
+ * the header, at 'header_size' bytes from the beginning of the file.
+ *
+ * Records the state of the arena as of the last checkpoint, see
+ * 'tiltyard_file_checkpoint'.
+ */
+typedef struct TiltyardFileHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t header_size;
+	uint64_t capacity;
+	uint64_t offset;
+	uint64_t top;
+	uint64_t high_water;
+	uint64_t alloc_count;
+	uint64_t root;
+} TiltyardFileHeader;
+
+/* Position of an object in a fixed arena, which stays valid when the arena's
+ * memory maps at a different address. 0 stands for NULL.
+ */
+typedef uint64_t TiltyardRel;
+
+Arena *tiltyard_create_file(const char *path, size_t capacity);
+bool tiltyard_file_checkpoint(Arena *arena);
+void tiltyard_file_set_root(Arena *arena, const void *root);
+void *tiltyard_file_get_root(Arena *arena);
+void tiltyard_file_close(Arena *arena);
+
+/* Returns the position of 'ptr', which points into the memory of the
+ * fixed arena 'arena', or 0 if 'ptr' is NULL.
+ */
+static inline TiltyardRel tiltyard_rel_from_ptr(const Arena *arena, const void *ptr)
+{
+	return ptr ? (TiltyardRel)((const uint8_t *)ptr - arena->base) + 1 : 0;
+}
+
+/* Returns the pointer to the position 'rel' of the fixed arena 'arena',
+ * or NULL if 'rel' is 0.
+ */
+static inline void *tiltyard_rel_to_ptr(const Arena *arena, TiltyardRel rel)
+{
+	return rel ? (void *)(arena->base + (size_t)(rel - 1)) : NULL;
+}
+
+/* Typed helper of 'tiltyard_rel_to_ptr'. */
+#define TILTYARD_REL_TO(arena, rel, type) ((type *)tiltyard_rel_to_ptr((arena), (rel)))
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "tiltyard_API.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Amount of control bytes probed at once. */
+#define TILTYARD_MAP_GROUP_WIDTH 16
+
+typedef uint64_t (*TiltyardMapHash)(const void *key, size_t key_size);
+typedef bool (*TiltyardMapEqual)(const void *a, const void *b, size_t key_size);
+
+/* Open-addressing hash map living in an arena.
+ *
+ * Every slot has a control byte, either empty, deleted, or the low 7 bits
+ * of the hash of its key, and the control bytes are probed in groups of
+ * TILTYARD_MAP_GROUP_WIDTH. The control bytes and the slots, which hold
+ * a copy of the key followed by the value, are a single arena allocation.
+ */
+typedef struct {
+	Arena *arena;
+	uint8_t *block;
+	uint8_t *ctrl;
+	uint8_t *slots;
+	size_t block_size;
+	size_t capacity;
+	size_t length;
+	size_t growth_left;
+	size_t key_size;
+	size_t value_size;
+	size_t value_offset;
+	size_t slot_size;
+	size_t alignment;
+	TiltyardMapHash hash;
+	TiltyardMapEqual equal;
+} TiltyardMap;
+
+/* Interned string, the key of the interner's map. */
+typedef struct {
+	const char *data;
+	size_t length;
+	uint64_t hash;
+} TiltyardInternKey;
+
+/* Table of unique strings living in an arena. */
+typedef struct {
+	TiltyardMap map;
+} TiltyardInterner;
+
+uint64_t tiltyard_hash_bytes(const void *data, size_t size);
+
+void tiltyard_map_init(TiltyardMap *map, Arena *arena, size_t key_size, size_t value_size, size_t alignment,
+		       size_t count, TiltyardMapHash hash, TiltyardMapEqual equal);
+void *tiltyard_map_find(TiltyardMap *map, const void *key);
+void *tiltyard_map_insert(TiltyardMap *map, const void *key, bool *inserted);
+bool tiltyard_map_remove(TiltyardMap *map, const void *key);
+bool tiltyard_map_next(TiltyardMap *map, size_t *index, void **key, void **value);
+
+void tiltyard_interner_init(TiltyardInterner *interner, Arena *arena, size_t count);
+const char *tiltyard_intern(TiltyardInterner *interner, const char *text, size_t length);
+const char *tiltyard_intern_cstr(TiltyardInterner *interner, const char *text);
+
+/* Typed helper, keys are hashed and compared as raw bytes. */
+#define TILTYARD_MAP_INIT(map, arena, key_type, value_type, count) \
+	tiltyard_map_init((map), (arena), sizeof(key_type), sizeof(value_type), \
+			  TILTYARD_ALIGNOF(key_type) > TILTYARD_ALIGNOF(value_type) ? \
+			  TILTYARD_ALIGNOF(key_type) : TILTYARD_ALIGNOF(value_type), \
+			  (count), NULL, NULL)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "tiltyard_API.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TILTYARD_CACHE_LINE 64
+#define TILTYARD_POOL_CHUNK_SIZE 4096
+
+/* Size classes of a pool set: 16, 32, 64, ..., 2048 bytes. */
+#define TILTYARD_POOL_MIN_CLASS_SHIFT 4
+#define TILTYARD_POOL_CLASS_AMOUNT 8
+
+/* Free slot of a pool, linked into the pool's free list. */
+typedef struct TiltyardPoolSlot {
+	struct TiltyardPoolSlot *next;
+} TiltyardPoolSlot;
+
+/* Fixed-size slots carved from an arena, recycled through a free list. */
+typedef struct {
+	Arena *arena;
+	TiltyardPoolSlot *free_list;
+	uint8_t *chunk_cursor;
+	size_t chunk_left;
+
+	size_t slot_size;
+	size_t alignment;
+
+	size_t live;
+	size_t slot_count;
+	size_t chunk_count;
+	size_t alloc_count;
+	size_t free_count;
+} TiltyardPool;
+
+typedef struct {
+	size_t slot_size;
+	size_t slot_count;
+	size_t live;
+	size_t free;
+	size_t chunk_count;
+	size_t alloc_count;
+	size_t free_count;
+	TiltyardStats arena;
+} TiltyardPoolStats;
+
+/* One pool per size class, all carving slots from the same arena. */
+typedef struct {
+	Arena *arena;
+	TiltyardPool classes[TILTYARD_POOL_CLASS_AMOUNT];
+} TiltyardPoolSet;
+
+void tiltyard_pool_init(TiltyardPool *pool, Arena *arena, size_t slot_size, size_t alignment);
+void *tiltyard_pool_alloc_slow(TiltyardPool *pool);
+void tiltyard_pool_reset(TiltyardPool *pool);
+TiltyardPoolStats tiltyard_pool_get_stats(TiltyardPool *pool);
+
+void tiltyard_pool_set_init(TiltyardPoolSet *set, Arena *arena);
+void *tiltyard_pool_set_alloc(TiltyardPoolSet *set, size_t size);
+void tiltyard_pool_set_free(TiltyardPoolSet *set, void *ptr, size_t size);
+void tiltyard_pool_set_reset(TiltyardPoolSet *set);
+
+/* Allocate one slot from the pool.
+ *
+ * Returns:
+ * - A pointer to a slot of the pool's slot_size bytes.
+ * - NULL if there is not enough space in the arena.
+ *
+ * Notes:
+ * - Freed slots are reused first, then slots are carved from the
+ *   current chunk, and only a new chunk calls 'tiltyard_pool_alloc_slow'.
+ * - The memory is uninitialized.
+ */
+static inline void *tiltyard_pool_alloc(TiltyardPool *pool)
+{
+	TiltyardPoolSlot *slot = pool->free_list;
+
+	if (slot) {
+		pool->free_list = slot->next;
+	} else if (pool->chunk_left >= pool->slot_size) {
+		slot = (TiltyardPoolSlot *)(void *)pool->chunk_cursor;
+		pool->chunk_cursor += pool->slot_size;
+		pool->chunk_left -= pool->slot_size;
+	} else {
+		return tiltyard_pool_alloc_slow(pool);
+	}
+
+	pool->live++;
+#if TILTYARD_STATS
+	pool->alloc_count++;
+#endif
+	return slot;
+}
+
+/* Give a slot allocated from the pool back to it.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - 'ptr' must come from 'tiltyard_pool_alloc' on the same pool,
+ *   a NULL 'ptr' is ignored.
+ * - The first bytes of the slot are used to link it to the free list.
+ */
+static inline void tiltyard_pool_free(TiltyardPool *pool, void *ptr)
+{
+	if (!ptr) return;
+
+	TiltyardPoolSlot *slot = (TiltyardPoolSlot *)ptr;
+	slot->next = pool->free_list;
+	pool->free_list = slot;
+	pool->live--;
+#if TILTYARD_STATS
+	pool->free_count++;
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "tiltyard_API.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TILTYARD_RING_GRANULE 16
+
+/* Header in front of every message of a ring arena. 'word' holds the bytes
+ * taken by the message, header included, and the flags below.
+ */
+typedef struct {
+	_Atomic size_t word;
+	size_t size;
+} TiltyardRingHeader;
+
+/* The message was published and can be read by the consumer. */
+#define TILTYARD_RING_READY ((size_t)1)
+/* The bytes up to the end of the ring are skipped, the next message is at its beginning. */
+#define TILTYARD_RING_SKIP ((size_t)2)
+
+/* Arena whose memory is recycled in FIFO order: producers allocate messages
+ * at the head and the consumer releases them at the tail.
+ */
+typedef struct {
+	uint8_t *base;
+	size_t capacity;
+	size_t mask;
+
+	_Alignas(64) atomic_size_t head;
+	atomic_size_t high_water;
+	atomic_size_t alloc_count;
+
+	_Alignas(64) atomic_size_t tail;
+} TiltyardRingArena;
+
+TiltyardRingArena *tiltyard_ring_create(size_t capacity);
+
+void *tiltyard_ring_alloc(TiltyardRingArena *ring, size_t size);
+void tiltyard_ring_publish(TiltyardRingArena *ring, void *ptr);
+
+void *tiltyard_ring_peek(TiltyardRingArena *ring, size_t *size);
+void tiltyard_ring_release(TiltyardRingArena *ring, void *ptr);
+
+void tiltyard_ring_destroy(TiltyardRingArena *ring);
+
+TiltyardStats tiltyard_ring_get_stats(TiltyardRingArena *ring);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "tiltyard_API.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Amount of scratch arenas of every thread. */
+#define TILTYARD_SCRATCH_COUNT 2
+
+/* Address space reserved by every scratch arena, see tiltyard_create_virtual. */
+#define TILTYARD_SCRATCH_RESERVE ((size_t)64 * 1024 * 1024)
+#define TILTYARD_SCRATCH_COMMIT_GRANULE ((size_t)64 * 1024)
+
+/* Saved position of an arena, restored when the scope ends. */
+typedef struct {
+	Arena *arena;
+	size_t marker;
+} TiltyardTemp;
+
+TiltyardTemp tiltyard_temp_begin(Arena *arena);
+void tiltyard_temp_end(TiltyardTemp temp);
+void tiltyard_temp_cleanup(TiltyardTemp *temp);
+
+void tiltyard_scratch_configure(size_t reserve);
+TiltyardTemp tiltyard_scratch_begin(Arena *const *conflicts, size_t conflict_count);
+void tiltyard_scratch_release(void);
+
+/* Declares 'name' as a temporary scope of 'arena' that ends by itself
+ * when 'name' goes out of scope, so the marker is never left unrestored.
+ */
+#define TILTYARD_TEMP_AUTO(name, arena) \
+	TiltyardTemp name __attribute__((cleanup(tiltyard_temp_cleanup))) = tiltyard_temp_begin(arena)
+
+/* Same as TILTYARD_TEMP_AUTO, on a scratch arena of the calling thread
+ * that is not any of the 'count' arenas in 'conflicts'.
+ */
+#define TILTYARD_SCRATCH_AUTO(name, conflicts, count) \
+	TiltyardTemp name __attribute__((cleanup(tiltyard_temp_cleanup))) = tiltyard_scratch_begin((conflicts), (count))
+
+#ifdef __cplusplus
+}
+
+namespace tiltyard {
+
+/* Restores the marker of an arena when it goes out of scope. */
+class TempScope {
+public:
+	explicit TempScope(Arena *arena) : temp_(tiltyard_temp_begin(arena)) {}
+	TempScope(Arena *const *conflicts, size_t conflict_count)
+		: temp_(tiltyard_scratch_begin(conflicts, conflict_count)) {}
+	~TempScope() { tiltyard_temp_end(temp_); }
+
+	TempScope(const TempScope &) = delete;
+	TempScope &operator=(const TempScope &) = delete;
+
+	Arena *arena() const { return temp_.arena; }
+	operator Arena *() const { return temp_.arena; }
+
+private:
+	TiltyardTemp temp_;
+};
+
+} /* namespace tiltyard */
+#endif
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "tiltyard_API.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* First bytes of the shared memory of every shared arena. */
+#define TILTYARD_SHARED_MAGIC "TYSHARED"
+
+/* Version of the layout of TiltyardSharedHeader, other versions are refused. */
+#define TILTYARD_SHARED_VERSION 1
+
+#define TILTYARD_SHARED_GRANULE 16
+
+/* Bits of a TiltyardSharedHandle holding the position, the rest hold the generation. */
+#define TILTYARD_SHARED_OFFSET_BITS 40
+
+/* Biggest capacity of a shared arena. */
+#define TILTYARD_SHARED_MAX_CAPACITY (((size_t)1 << TILTYARD_SHARED_OFFSET_BITS) - 1)
+
+/* Header at the beginning of the shared memory of a shared arena, seen by
+ * every process mapping it. Its memory follows the header, at 'header_size'
+ * bytes from the beginning.
+ */
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t header_size;
+	uint64_t capacity;
+
+	_Alignas(64) _Atomic uint64_t offset;
+
+	_Alignas(64) _Atomic uint64_t generation;
+	_Atomic uint64_t root;
+	_Atomic uint64_t high_water;
+	_Atomic uint64_t alloc_count;
+} TiltyardSharedHeader;
+
+/* Arena whose memory is shared by several processes, each process has its own
+ * TiltyardSharedArena mapping the same memory, at its own address.
+ */
+typedef struct {
+	TiltyardSharedHeader *header;
+	uint8_t *base;
+	size_t capacity;
+	size_t mapped_size;
+	int fd;
+	char *name;
+} TiltyardSharedArena;
+
+/* Position of an object in a shared arena, valid in every process mapping it,
+ * tagged with the generation it was allocated in. 0 stands for NULL.
+ */
+typedef uint64_t TiltyardSharedHandle;
+
+TiltyardSharedArena *tiltyard_shared_create(const char *name, size_t capacity);
+TiltyardSharedArena *tiltyard_shared_open(const char *name);
+TiltyardSharedArena *tiltyard_shared_open_fd(int fd);
+
+void *tiltyard_shared_alloc(TiltyardSharedArena *arena, size_t size);
+void *tiltyard_shared_alloc_aligned(TiltyardSharedArena *arena, size_t size, size_t alignment);
+
+TiltyardSharedHandle tiltyard_shared_handle(TiltyardSharedArena *arena, const void *ptr);
+void *tiltyard_shared_resolve(TiltyardSharedArena *arena, TiltyardSharedHandle handle);
+bool tiltyard_shared_valid(TiltyardSharedArena *arena, TiltyardSharedHandle handle);
+
+void tiltyard_shared_set_root(TiltyardSharedArena *arena, TiltyardSharedHandle root);
+TiltyardSharedHandle tiltyard_shared_get_root(TiltyardSharedArena *arena);
+
+void tiltyard_shared_reset(TiltyardSharedArena *arena);
+void tiltyard_shared_destroy(TiltyardSharedArena *arena);
+
+int tiltyard_shared_get_fd(TiltyardSharedArena *arena);
+uint64_t tiltyard_shared_get_generation(TiltyardSharedArena *arena);
+TiltyardStats tiltyard_shared_get_stats(TiltyardSharedArena *arena);
+
+#ifdef __cplusplus
+}
+#endif
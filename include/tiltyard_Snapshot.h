@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "tiltyard_API.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Amount of snapshots that can be open at once in the process. */
+#define TILTYARD_SNAPSHOT_MAX 64
+
+/* Saved contents of an arena, see tiltyard_snapshot_begin.
+ *
+ * The pages holding allocations are write protected, and every page is
+ * copied to 'copies' the first time it is written, so the arena can be
+ * put back as it was by copying back only those pages. 'claims' holds
+ * the state of every protected page, see tiltyard_snapshot_save_page.
+ *
+ * The first 'edge_count' copies are the pages the arena shares with
+ * other objects, copied when the snapshot is taken and never protected.
+ * The snapshot lives at the start of its own mapping, 'storage_size'
+ * bytes long, so nothing the fault handler writes is ever protected.
+ */
+typedef struct {
+	Arena *arena;
+	Arena saved;
+
+	uint8_t *low_beg;
+	uint8_t *low_end;
+	uint8_t *high_beg;
+	uint8_t *high_end;
+
+	uint8_t **pages;
+	atomic_uchar *claims;
+	uint8_t *copies;
+	atomic_size_t page_count;
+	size_t edge_count;
+	size_t max_pages;
+	size_t page_size;
+	size_t storage_size;
+	size_t slot;
+} TiltyardSnapshot;
+
+TiltyardSnapshot *tiltyard_snapshot_begin(Arena *arena);
+void tiltyard_snapshot_restore(TiltyardSnapshot *snapshot);
+void tiltyard_snapshot_end(TiltyardSnapshot *snapshot);
+size_t tiltyard_snapshot_get_page_count(TiltyardSnapshot *snapshot);
+
+#ifdef __cplusplus
+}
+#endif
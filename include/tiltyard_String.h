@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "tiltyard_API.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Growable string living in an arena, always terminated by '\0'. */
+typedef struct {
+	Arena *arena;
+	char *data;
+	size_t length;
+	size_t capacity;
+} TiltyardString;
+
+void tiltyard_string_init(TiltyardString *string, Arena *arena, size_t capacity);
+
+bool tiltyard_string_append(TiltyardString *string, const char *text, size_t length);
+bool tiltyard_string_append_cstr(TiltyardString *string, const char *text);
+bool tiltyard_string_append_char(TiltyardString *string, char c);
+
+bool tiltyard_string_appendf(TiltyardString *string, const char *format, ...)
+	__attribute__((format(printf, 2, 3)));
+bool tiltyard_string_appendv(TiltyardString *string, const char *format, va_list args)
+	__attribute__((format(printf, 2, 0)));
+
+char *tiltyard_string_finish(TiltyardString *string);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "tiltyard_API.h"
+
+/* Amount of size classes of a block pool, one per power of two. */
+#define TILTYARD_BLOCK_POOL_CLASSES 64
+
+/* Amount of blocks a pool keeps at most, the blocks pushed
+ * past it are freed instead.
+ */
+#define TILTYARD_BLOCK_POOL_MAX_BLOCKS 256
+
+/* Amount of blocks an arena with a block pool keeps in its block cache
+ * when it is reset, the others go back to the pool.
+ */
+#define TILTYARD_POOLED_CACHED_BLOCKS 1
+
+/* Lock-free pool of blocks shared by the arenas of several threads.
+ *
+ * Blocks are kept in one stack per size class, the class of a block
+ * being the highest power of two not above its capacity. Each head
+ * packs a pointer to the top block with a tag bumped on every change,
+ * so the compare-and-swap of a pop fails when the head was popped and
+ * pushed back in between, and the stacks are not affected by the ABA problem.
+ * 'poppers' counts the pops in progress, which may still read a block
+ * that was popped by another thread in between.
+ */
+struct TiltyardBlockPool {
+	_Alignas(64) _Atomic uint64_t heads[TILTYARD_BLOCK_POOL_CLASSES];
+	atomic_size_t count;
+	atomic_size_t poppers;
+};
+
+void tiltyard_block_pool_push(TiltyardBlockPool *pool, TiltyardBlock *blocks);
+TiltyardBlock *tiltyard_block_pool_pop(TiltyardBlockPool *pool, size_t needed, size_t room);
+void tiltyard_block_pool_drain(TiltyardBlockPool *pool);
+size_t tiltyard_block_pool_count(TiltyardBlockPool *pool);
+
+TiltyardBlockPool *tiltyard_global_block_pool(void);
+
+void tiltyard_thread_arena_configure(size_t block_capacity, size_t max_capacity);
+Arena *tiltyard_thread_arena(void);
+void tiltyard_thread_arena_release(void);
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "tiltyard_API.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Growable array of elements of 'element_size' bytes living in an arena. */
+typedef struct {
+	Arena *arena;
+	uint8_t *data;
+	size_t length;
+	size_t capacity;
+	size_t element_size;
+	size_t alignment;
+} TiltyardVector;
+
+void tiltyard_vector_init(TiltyardVector *vector, Arena *arena, size_t element_size, size_t alignment, size_t capacity);
+bool tiltyard_vector_reserve(TiltyardVector *vector, size_t capacity);
+void *tiltyard_vector_push_slow(TiltyardVector *vector, size_t count);
+void tiltyard_vector_shrink(TiltyardVector *vector);
+
+/* Appends 'count' uninitialized elements to the vector.
+ *
+ * Returns:
+ * - A pointer to the first element appended.
+ * - NULL if the vector could not grow.
+ *
+ * Notes:
+ * - Only the pushes that do not fit in the vector's capacity
+ *   call a function, 'tiltyard_vector_push_slow'.
+ */
+static inline void *tiltyard_vector_push_n(TiltyardVector *vector, size_t count)
+{
+	if (TILTYARD_UNLIKELY(count > vector->capacity - vector->length))
+		return tiltyard_vector_push_slow(vector, count);
+
+	void *slot = vector->data + vector->length * vector->element_size;
+	vector->length += count;
+	return slot;
+}
+
+/* Appends one uninitialized element to the vector. */
+static inline void *tiltyard_vector_push(TiltyardVector *vector)
+{
+	return tiltyard_vector_push_n(vector, 1);
+}
+
+/* Returns a pointer to the element at 'index', which must be < length. */
+static inline void *tiltyard_vector_at(TiltyardVector *vector, size_t index)
+{
+	return vector->data + index * vector->element_size;
+}
+
+/* Typed helpers, 'type' must be the type the vector was initialized with. */
+#define TILTYARD_VECTOR_INIT(vector, arena, type, capacity) \
+	tiltyard_vector_init((vector), (arena), sizeof(type), TILTYARD_ALIGNOF(type), (capacity))
+
+#define TILTYARD_VECTOR_PUSH(vector, type, value) \
+	do { \
+		type *tiltyard_slot_ = (type *)tiltyard_vector_push(vector); \
+		if (tiltyard_slot_) *tiltyard_slot_ = (value); \
+	} while (0)
+
+#define TILTYARD_VECTOR_AT(vector, type, index) \
+	(((type *)(void *)(vector)->data)[index])
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,10 +1,19 @@
+#define _GNU_SOURCE
+
+#include <inttypes.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include "../include/tiltyard_API.h"
+#include "../include/tiltyard_Clean.h"
 #include "../include/tiltyard_Error.h"
+#include "../include/tiltyard_File.h"
+#include "../include/tiltyard_Thread.h"
 
 /* Check if a+b overflows size_t
  *
@@ -24,568 +33,3030 @@ static inline int size_add_overflow(size_t a, size_t b)
 	return 0;
 }
 
-/* Create a new arena with size 'capacity'.
- *
- * Create space in the heap for the arena
- * through malloc
+/* Rounds 'value' up to a multiple of 'granule'
  *
  * Returns:
- * - A null pointer if the capacity is 0 or
- *   there is not enough memory in the heap for that capacity or the arena pointer.
- * - A pointer to a arena allocated in the heap if there is enough
- *   memory in the heap for the capacity given.
- *
- * Notes:
- * - Allocates memory in the heap through malloc 2 times, one for the arena
- *   and the other one for the base of the arena (capacity).
- * - The memory allocated in the heap for the arena and its base
- *   must be freed through tiltyard_destroy, tiltyard_destroy_and_null, or
- *   tiltyard_wipe_destroy_and_null functions.
+ * - 'value' rounded up to a multiple of 'granule'.
+ * - SIZE_MAX if the rounded value overflows size_t.
  */
-Arena *tiltyard_create(size_t capacity)
+static inline size_t size_round_up(size_t value, size_t granule)
 {
-	if (capacity == 0)
-		tiltyard_handle_error(SIZE_EQUALS_ZERO, TILTYARD_CREATE, true);
+	size_t rest = value % granule;
 
-	Arena *arena = malloc(sizeof(Arena));
-	if (!arena) tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_ARENA, TILTYARD_CREATE, true);
-	
-	arena->base = malloc(capacity);
-	if (!arena->base) {
-		free(arena);
-		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_SIZE_OF_ARENA, TILTYARD_CREATE, true);
-	}
+	if (rest == 0) return value;
+	if (size_add_overflow(value, granule - rest)) return SIZE_MAX;
+	return value + granule - rest;
+}
+
+/* Returns the size of a page of the system. */
+static size_t tiltyard_page_size(void)
+{
+	long page_size = sysconf(_SC_PAGESIZE);
+
+	return page_size > 0 ? (size_t)page_size : 4096;
+}
 
+/* Sets every field of 'arena' to the state of a new, empty arena
+ * of kind 'kind' whose memory is 'capacity' bytes at 'base'.
+ *
+ * Returns:
+ * - Nothing.
+ */
+static void tiltyard_init(Arena *arena, enum tiltyard_arena_kind kind, uint8_t *base, size_t capacity)
+{
+	arena->base = base;
 	arena->capacity = capacity;
 	arena->offset = 0;
+	arena->limit = capacity;
+
 	arena->last_alloc_offset = 0;
 	arena->high_water = 0;
 	arena->alloc_count = 0;
-	return arena;
+
+	arena->kind = kind;
+
+	arena->block = NULL;
+	arena->block_cache = NULL;
+	arena->block_pool = NULL;
+	arena->block_start = 0;
+	arena->max_capacity = capacity;
+	arena->block_count = 1;
+	arena->cached_block_count = 0;
+
+	arena->commit_granule = 0;
+	arena->commit_peak = 0;
+
+	arena->decommit_mode = TILTYARD_DECOMMIT_NEVER;
+	arena->decommit_slack = 0;
+	arena->decommit_peak = 0;
+	arena->decommitted = 0;
+	arena->refaulted = 0;
+
+	arena->dirty_high_water = kind == TILTYARD_GROWABLE_ARENA ? SIZE_MAX : 0;
+
+	arena->clean_threads = 1;
+	arena->clean_drop_pages = false;
+
+	arena->mapped_size = 0;
+	arena->create_options = 0;
+	arena->huge_pages = false;
+
+	arena->parent = NULL;
+	arena->parent_marker = 0;
+	arena->parent_end = 0;
+	arena->owns_base = true;
+	arena->owns_header = true;
+	arena->borrowed = false;
+
+	arena->open_temps = 0;
+
+	arena->top = capacity;
+	arena->top_dirty = kind == TILTYARD_GROWABLE_ARENA ? SIZE_MAX : capacity;
+	arena->top_high_water = 0;
+	arena->top_alloc_count = 0;
+
+	arena->large_threshold = SIZE_MAX;
+	arena->large_allocs = NULL;
+	arena->large_count = 0;
+	arena->large_bytes = 0;
+
+	arena->overflow_policy = TILTYARD_OVERFLOW_ABORT;
+	arena->overflow_fallback = NULL;
+	arena->overflow_callback = NULL;
+	arena->overflow_user = NULL;
+	arena->overflow_count = 0;
+
+	arena->file_header = NULL;
+	arena->file_fd = -1;
+	arena->file_root = 0;
+
+	arena->snapshot_open = false;
 }
 
-/* Allocate 'size' bytes from the arena with the default alignment
+/* Size of the header of an arena created inside of a buffer, rounded
+ * so the arena's memory that follows it is aligned to 16 bytes.
+ */
+#define TILTYARD_ARENA_HEADER_SIZE ((sizeof(Arena) + 15) & ~(size_t)15)
+
+/* Returns the offset above which every byte of the arena is known to be zero.
  *
- * The default alignment is sizeof(void *).
+ * Bytes are only written through allocations, which are always below the
+ * offset, so the mark is the biggest of the offset and the dirty_high_water,
+ * the highest offset the arena had before moving its offset back.
  *
  * Returns:
- * - A pointer into the arena if there is enough capacity.
- * - NULL if there is not enough space or arena == NULL.
+ * - The offset from which the arena's memory is zero.
+ * - SIZE_MAX on growable arenas, whose blocks are never known to be zero.
+ */
+static inline size_t tiltyard_dirty_mark(Arena *arena)
+{
+	return arena->offset > arena->dirty_high_water ? arena->offset : arena->dirty_high_water;
+}
+
+/* Records the arena's offset in the dirty_high_water before it is moved back.
+ *
+ * Returns:
+ * - Nothing.
  *
  * Notes:
- * - Does NOT call malloc/free; the returned pointer comes
- *   from the already allocated memory for the arena.
- * - The memory is uninitialized (use tiltyard_calloc if you need
- *   zeroed memory)
+ * - Must be called by every function that makes the offset smaller,
+ *   the allocations only make it bigger so they never need to.
  */
-void *tiltyard_alloc(Arena *arena, size_t size)
+static inline void tiltyard_mark_dirty(Arena *arena)
 {
-	return tiltyard_alloc_aligned(arena, size, sizeof(void *));
+	if (arena->offset > arena->dirty_high_water)
+		arena->dirty_high_water = arena->offset;
 }
 
-/* Allocate size bytes from the arena with the default alignment,
- * and zero-initialize the memory.
+/* Returns the offset from which the top end of the arena may be dirty.
  *
- * Same behavior as 'tiltyard_alloc' except:
- * - The returned memory is set to all zero bytes.
+ * Bytes allocated from the top end are written above the arena's top,
+ * so the mark is the smallest of the top and the top_dirty, the lowest
+ * top the arena had before moving its top forward.
+ */
+static inline size_t tiltyard_top_dirty_mark(Arena *arena)
+{
+	return arena->top < arena->top_dirty ? arena->top : arena->top_dirty;
+}
+
+/* Records that every byte of the arena from 'beg' to 'end' is zero.
+ *
+ * Lowers the dirty_high_water to 'beg' when the range reaches
+ * the dirty mark, so every byte from 'beg' on is zero.
  *
  * Returns:
- * - A pointer into the arena if there is enough capacity.
- * - NULL if there is not enough space or arena == NULL.
+ * - Nothing.
+ */
+static inline void tiltyard_mark_clean(Arena *arena, size_t beg, size_t end)
+{
+	if (arena->kind == TILTYARD_GROWABLE_ARENA)
+		return;
+
+	if (end >= tiltyard_dirty_mark(arena) && beg < arena->dirty_high_water)
+		arena->dirty_high_water = beg;
+}
+
+/* Size of a block header, rounded so the block's memory keeps
+ * the alignment malloc gave to the header.
+ */
+#define TILTYARD_BLOCK_HEADER_SIZE ((sizeof(TiltyardBlock) + 15) & ~(size_t)15)
+
+/* Returns the first byte of the memory of 'block'. */
+static inline uint8_t *tiltyard_block_data(TiltyardBlock *block)
+{
+	return (uint8_t *)block + TILTYARD_BLOCK_HEADER_SIZE;
+}
+
+/* Allocate a new block of 'capacity' bytes through malloc
+ *
+ * Returns:
+ * - A pointer to the block if there is enough memory in the heap.
+ * - NULL if there is not enough memory in the heap.
  *
  * Notes:
- * - Does NOT call malloc/free; the returned pointer comes
- *   from the already allocated memory for the arena.
+ * - The block is not linked to any arena.
  */
-void *tiltyard_calloc(Arena *arena, size_t size)
+static TiltyardBlock *tiltyard_block_new(size_t capacity)
 {
-	void *ptr = tiltyard_alloc(arena, size);
+	if (size_add_overflow(TILTYARD_BLOCK_HEADER_SIZE, capacity))
+		return NULL;
 
-	if  (!ptr) tiltyard_handle_error(EXCEEDED_ARENA_CAPACITY, TILTYARD_CALLOC, true);
+	TiltyardBlock *block = malloc(TILTYARD_BLOCK_HEADER_SIZE + capacity);
+	if (!block) return NULL;
 
-	memset(ptr, 0, size);
-	return ptr;
+	block->prev = NULL;
+	block->start = 0;
+	block->capacity = capacity;
+	return block;
 }
 
-/* Allocate size bytes from the arena with a custom alignment.
+/* Frees a list of blocks linked through their 'prev' field. */
+static void tiltyard_free_blocks(TiltyardBlock *block)
+{
+	while (block) {
+		TiltyardBlock *prev = block->prev;
+		free(block);
+		block = prev;
+	}
+}
+
+/* Gives a list of blocks of 'arena' back to where they came from.
  *
- * Same behavior as 'tiltyard_alloc' except:
- * - The memory is aligned based on 'alignment' instead of a
- *   default one.
+ * Returns:
+ * - Nothing.
  *
- * This function also assign stats such as last_alloc, alloc_count,
- * and high_water to the arena for each allocation.
+ * Notes:
+ * - Blocks are pushed to the arena's block pool if it has one,
+ *   otherwise they are freed.
+ */
+static void tiltyard_drop_blocks(Arena *arena, TiltyardBlock *block)
+{
+	if (!block) return;
+
+	if (!arena->block_pool) {
+		tiltyard_free_blocks(block);
+		return;
+	}
+
+	tiltyard_block_pool_push(arena->block_pool, block);
+}
+
+/* Makes 'block' the block the arena allocates from.
  *
  * Returns:
- * - A pointer into the arena if there is enough capacity.
- * - NULL if there is not enough space or arena == NULL.
+ * - Nothing.
  *
  * Notes:
- * - Does NOT call malloc/free; the returned pointer comes
- *   from the already allocated memory for the arena.
- * - The memory is uninitialized (use tiltyard_calloc_aligned if you need
- *   zeroed memory)
+ * - 'block->start' must already hold the offset where the block begins,
+ *   the arena's capacity becomes the end of the block.
+ * - The arena's offset is not changed.
  */
-void *tiltyard_alloc_aligned(Arena *arena, size_t size, size_t alignment)
+static void tiltyard_use_block(Arena *arena, TiltyardBlock *block)
 {
-	if (!arena)
-		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_ALLOC_ALIGNED, true);
+	arena->block = block;
+	arena->base = tiltyard_block_data(block);
+	arena->block_start = block->start;
+	arena->capacity = block->start + block->capacity;
+	arena->limit = arena->capacity;
+	arena->top = arena->capacity;
+}
 
-	if (alignment == 0 || (alignment & (alignment - 1)) != 0)
-		tiltyard_handle_error(INVALID_ALIGNMENT, TILTYARD_ALLOC_ALIGNED, true);
+/* Takes from the block cache the first block holding at least 'needed'
+ * bytes and at most 'room' bytes.
+ *
+ * Returns:
+ * - The block removed from the cache if one fits.
+ * - NULL if no cached block fits.
+ */
+static TiltyardBlock *tiltyard_take_cached_block(Arena *arena, size_t needed, size_t room)
+{
+	TiltyardBlock **link = &arena->block_cache;
 
-	size_t aligned_offset = (arena->offset + alignment - 1) & ~(alignment - 1);
+	for (TiltyardBlock *block = *link; block; link = &block->prev, block = *link) {
+		if (block->capacity < needed || block->capacity > room)
+			continue;
 
-	if (size_add_overflow(aligned_offset, size) || aligned_offset + size > arena->capacity)
-		tiltyard_handle_error(ALIGNMENT_TOO_BIG, TILTYARD_ALLOC_ALIGNED, true);
+		*link = block->prev;
+		arena->cached_block_count--;
+		return block;
+	}
+	return NULL;
+}
 
-	void *ptr = (char *)arena->base + aligned_offset;
-	arena->last_alloc_offset = arena->offset;
-	arena->alloc_count++;
-	arena->offset = aligned_offset + size;
-	if (arena->offset > arena->high_water)
-		arena->high_water = arena->offset;
-	return ptr;
+/* Moves the current block of a growable arena to its block cache
+ * and makes the previous block the current one.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - The first block of the arena is never released.
+ * - The arena's offset is not changed.
+ */
+static void tiltyard_release_block(Arena *arena)
+{
+	TiltyardBlock *block = arena->block;
+
+	tiltyard_use_block(arena, block->prev);
+	block->prev = arena->block_cache;
+	arena->block_cache = block;
+	arena->block_count--;
+	arena->cached_block_count++;
 }
 
-/* Allocate size bytes from the arena with a custom alignment,
- * and zero-initialize the memory.
+/* Pushes the cached blocks of a pooled arena back to its block pool,
+ * but the first TILTYARD_POOLED_CACHED_BLOCKS ones, so other arenas of
+ * the pool can reuse the blocks this one grew into.
  *
- * Same behavior as 'tiltyard_calloc' except:
- * - The memory is aligned based on 'alignment' instead of a
- *   default one.
+ * Returns:
+ * - Nothing.
+ */
+static void tiltyard_trim_block_cache(Arena *arena)
+{
+	if (!arena->block_pool) return;
+
+	TiltyardBlock **link = &arena->block_cache;
+	for (size_t kept = 0; *link && kept < TILTYARD_POOLED_CACHED_BLOCKS; kept++)
+		link = &(*link)->prev;
+
+	TiltyardBlock *blocks = *link;
+	*link = NULL;
+	for (TiltyardBlock *block = blocks; block; block = block->prev)
+		arena->cached_block_count--;
+
+	tiltyard_block_pool_push(arena->block_pool, blocks);
+}
+
+/* Reports that an arena has no room for an allocation made under 'policy'.
+ *
+ * Only allocations under TILTYARD_OVERFLOW_ABORT report it, which aborts,
+ * every other policy handles the allocation afterwards.
+ *
+ * Returns:
+ * - Nothing.
+ */
+static void tiltyard_report_overflow(enum tiltyard_overflow_policy policy, enum tiltyard_error_code code,
+				     enum tiltyard_func func)
+{
+	if (policy == TILTYARD_OVERFLOW_ABORT)
+		tiltyard_handle_error(code, func, true);
+}
+
+static void *tiltyard_alloc_policy(Arena *arena, size_t size, size_t alignment,
+				   enum tiltyard_overflow_policy policy);
+
+/* Allocate 'size' bytes aligned to 'alignment' from the arena's own memory,
+ * returning NULL instead of applying the arena's overflow policy.
  *
  * Returns:
  * - A pointer into the arena if there is enough capacity.
- * - NULL if there is not enough space or arena == NULL.
+ * - NULL if there is not enough space.
+ */
+static void *tiltyard_alloc_quiet(Arena *arena, size_t size, size_t alignment)
+{
+	return tiltyard_alloc_policy(arena, size, alignment, TILTYARD_OVERFLOW_NULL);
+}
+
+/* Chains a new block to a growable arena that can hold 'size' bytes
+ * aligned to 'alignment'.
+ *
+ * Blocks are taken from the block cache, then from the arena's
+ * block pool (if it has one) when possible, otherwise
+ * a new block twice as big as the current one (or as big as needed)
+ * is allocated, without ever going over the arena's max_capacity.
+ *
+ * Returns:
+ * - true if a block was chained.
+ * - false if the block would exceed the arena's max_capacity or
+ *   there is not enough memory in the heap for it.
  *
  * Notes:
- * - Does NOT call malloc/free; the returned pointer comes
- *   from the already allocated memory for the arena.
+ * - The arena's offset moves to the beginning of the new block, the
+ *   space left at the end of the previous block is not used anymore.
  */
-void *tiltyard_calloc_aligned(Arena *arena, size_t size, size_t alignment)
+static bool tiltyard_chain_block(Arena *arena, size_t size, size_t alignment,
+				 enum tiltyard_overflow_policy policy)
 {
-	void *ptr = tiltyard_alloc_aligned(arena, size, alignment);
+	if (size_add_overflow(size, alignment - 1)) {
+		tiltyard_report_overflow(policy, EXCEEDED_ARENA_CAPACITY, TILTYARD_ALLOC_ALIGNED);
+		return false;
+	}
 
-	if (!ptr)
-		tiltyard_handle_error(EXCEEDED_ARENA_CAPACITY, TILTYARD_CALLOC_ALIGNED, true);
+	size_t needed = size + alignment - 1;
+	size_t room = arena->max_capacity - arena->capacity;
+	if (needed > room) {
+		tiltyard_report_overflow(policy, EXCEEDED_ARENA_CAPACITY, TILTYARD_ALLOC_ALIGNED);
+		return false;
+	}
 
-	memset(ptr, 0, size);
-	return ptr;
+	TiltyardBlock *block = tiltyard_take_cached_block(arena, needed, room);
+	if (!block && arena->block_pool)
+		block = tiltyard_block_pool_pop(arena->block_pool, needed, room);
+	if (!block) {
+		size_t block_capacity = arena->block->capacity > SIZE_MAX / 2 ? SIZE_MAX : arena->block->capacity * 2;
+		if (block_capacity < needed) block_capacity = needed;
+		if (block_capacity > room) block_capacity = room;
+
+		block = tiltyard_block_new(block_capacity);
+		if (!block) {
+			tiltyard_report_overflow(policy, NOT_ENOUGH_SPACE_FOR_SIZE_OF_ARENA, TILTYARD_ALLOC_ALIGNED);
+			return false;
+		}
+	}
+
+	block->prev = arena->block;
+	block->start = arena->capacity;
+	arena->offset = arena->capacity;
+	arena->block_count++;
+	tiltyard_use_block(arena, block);
+	return true;
 }
 
-/* Frees arena and its based (which are allocated in the heap)
+/* Commits the pages of a virtual arena until at least 'end'.
  *
- * the arena's base and the arena itself will be freed using free
- * if 'arena' is not NULL.
+ * Pages are committed in multiples of the arena's commit_granule
+ * through mprotect, the arena's limit becomes the new committed watermark.
+ * Fixed arenas only commit again pages that were decommitted, which
+ * does not need mprotect.
+ *
+ * Pages committed below the highest watermark ever reached were
+ * decommitted before, and are counted as refaulted.
  *
  * Returns:
- * - Nothing
+ * - true if the pages were committed.
+ * - false if 'end' is beyond the arena's capacity or the
+ *   pages could not be committed.
+ */
+static bool tiltyard_commit(Arena *arena, size_t end, enum tiltyard_overflow_policy policy)
+{
+	if (end > arena->top) {
+		tiltyard_report_overflow(policy, EXCEEDED_ARENA_CAPACITY, TILTYARD_ALLOC_ALIGNED);
+		return false;
+	}
+
+	size_t new_limit = size_round_up(end, arena->commit_granule);
+	if (new_limit > arena->top)
+		new_limit = arena->top;
+
+	if (arena->kind == TILTYARD_VIRTUAL_ARENA &&
+	    mprotect(arena->base + arena->limit, new_limit - arena->limit, PROT_READ | PROT_WRITE) != 0) {
+		tiltyard_report_overflow(policy, VIRTUAL_MEMORY_COMMIT_FAILED, TILTYARD_ALLOC_ALIGNED);
+		return false;
+	}
+
+	if (arena->commit_peak > arena->limit)
+		arena->refaulted += (new_limit < arena->commit_peak ? new_limit : arena->commit_peak) - arena->limit;
+	if (arena->kind == TILTYARD_VIRTUAL_ARENA && new_limit > arena->commit_peak)
+		arena->commit_peak = new_limit;
+
+	arena->limit = new_limit;
+	return true;
+}
+
+/* Makes room for 'size' bytes aligned to 'alignment' when they do not fit
+ * below the arena's limit.
+ *
+ * Growable arenas chain a new block, virtual arenas and fixed arenas whose
+ * pages were decommitted commit more pages, every other arena has no more room.
+ *
+ * Returns:
+ * - true if there is room for the allocation.
+ * - false if there is no room for the allocation.
  *
  * Notes:
- * - The pointer to arena will still point to where it pointed, even
- *   though the memory was already freed, in case you want to null the pointer
- *   please consider using 'tiltyard_null', 'tiltyard_destroy_and_null',
- *   or 'tiltyard_wipe_destroy_and_null'.
- * - Until the OS process that the memory was freed, it will still contain
- *   what it already had before freeing, in case you want to zero what you
- *   wrote on that memory please consider using 'tiltyard_wipe'
- *   or 'tiltyard_wipe_destroy_and_null'
+ * - The caller must compute the aligned position again, since
+ *   the arena's base may have changed.
  */
-void tiltyard_destroy(Arena *arena) 
+static bool tiltyard_make_room(Arena *arena, size_t size, size_t alignment, size_t padding,
+			       enum tiltyard_overflow_policy policy)
 {
-	if (!arena)
-		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_DESTROY, false);
-	else {
+	switch (arena->kind) {
+	case TILTYARD_GROWABLE_ARENA:
+		return tiltyard_chain_block(arena, size, alignment, policy);
 
-		free(arena->base);
-		free(arena);
+	case TILTYARD_FIXED_ARENA:
+	case TILTYARD_VIRTUAL_ARENA:
+		if (size_add_overflow(padding, size) || size_add_overflow(arena->offset, padding + size)) {
+			tiltyard_report_overflow(policy, EXCEEDED_ARENA_CAPACITY, TILTYARD_ALLOC_ALIGNED);
+			return false;
+		}
+		return tiltyard_commit(arena, arena->offset + padding + size, policy);
+
+	default:
+		tiltyard_report_overflow(policy, ALIGNMENT_TOO_BIG, TILTYARD_ALLOC_ALIGNED);
+		return false;
 	}
 }
 
-/* Zeroes all the memory in the arena.
+/* Releases the committed pages of the arena above 'marker' back to the OS,
+ * following the arena's decommit policy.
+ *
+ * The arena keeps committed the biggest of 'marker' and the peak offset
+ * of the previous resets, plus the arena's decommit_slack. The peak offset
+ * is halved on every reset, so a workload that keeps reaching the same
+ * offset does not fault its pages over and over again, while the pages
+ * of a single spike are released on the following resets.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Must be called before the arena's offset is moved to 'marker'.
+ * - Released pages read as zero (TILTYARD_DECOMMIT_DONTNEED) or either as
+ *   zero or as their previous contents (TILTYARD_DECOMMIT_FREE).
+ */
+static void tiltyard_decommit_above(Arena *arena, size_t marker)
+{
+	size_t keep = marker > arena->decommit_peak ? marker : arena->decommit_peak;
+	arena->decommit_peak = arena->offset > arena->decommit_peak / 2 ? arena->offset : arena->decommit_peak / 2;
+
+	if (size_add_overflow(keep, arena->decommit_slack))
+		return;
+
+	keep = size_round_up(keep + arena->decommit_slack, arena->commit_granule);
+	if (keep >= arena->limit)
+		return;
+
+	/* Pages of fixed arenas above the high_water were never touched. */
+	size_t top = arena->limit;
+	if (TILTYARD_STATS && arena->kind == TILTYARD_FIXED_ARENA && arena->high_water < top)
+		top = arena->high_water;
+
+	uintptr_t page_mask = (uintptr_t)tiltyard_page_size() - 1;
+	uintptr_t beg = ((uintptr_t)(arena->base + keep) + page_mask) & ~page_mask;
+	uintptr_t end = ((uintptr_t)(arena->base + top) + page_mask) & ~page_mask;
+	if (end > (uintptr_t)(arena->base + arena->limit))
+		end = (uintptr_t)(arena->base + arena->limit) & ~page_mask;
+	if (beg >= end)
+		return;
+
+	int advice = MADV_DONTNEED;
+#ifdef MADV_FREE
+	if (arena->decommit_mode == TILTYARD_DECOMMIT_FREE)
+		advice = MADV_FREE;
+#endif
+
+	if (madvise((void *)beg, (size_t)(end - beg), advice) != 0)
+		return;
+
+	/* Pages released through MADV_FREE may keep their contents. */
+	if (advice == MADV_DONTNEED)
+		tiltyard_mark_clean(arena, (size_t)(beg - (uintptr_t)arena->base), (size_t)(end - (uintptr_t)arena->base));
+
+	if (arena->kind == TILTYARD_VIRTUAL_ARENA)
+		mprotect((void *)beg, (size_t)(end - beg), PROT_NONE);
+
+	arena->decommitted += (size_t)(end - beg);
+	arena->limit = keep;
+	if (arena->kind == TILTYARD_FIXED_ARENA && top > arena->commit_peak)
+		arena->commit_peak = top;
+}
+
+/* Zeroes all bytes from 'beg' to 'end' of the arena.
+ *
+ * Bytes above the arena's dirty mark are already zero, so only
+ * the bytes below it are written, and the dirty mark is lowered
+ * to 'beg' when the range reaches it.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - On growable arenas only the blocks currently chained
+ *   to the arena are zeroed.
+ * - Decommitted pages of virtual arenas are not zeroed, so the dirty
+ *   mark is not lowered when they may keep their contents.
+ */
+static void tiltyard_zero_range(Arena *arena, size_t beg, size_t end)
+{
+	if (arena->kind != TILTYARD_GROWABLE_ARENA) {
+		size_t dirty = tiltyard_dirty_mark(arena);
+		size_t until = end < dirty ? end : dirty;
+		size_t top_dirty = tiltyard_top_dirty_mark(arena);
+		size_t from = beg > top_dirty ? beg : top_dirty;
+
+		if (arena->kind == TILTYARD_VIRTUAL_ARENA && until > arena->limit)
+			until = arena->limit;
+		if (beg < until)
+			tiltyard_bulk_zero(arena->base + beg, until - beg, arena->clean_threads, arena->clean_drop_pages);
+		if (from < until)
+			from = until;
+		if (from < end)
+			tiltyard_bulk_zero(arena->base + from, end - from, arena->clean_threads, arena->clean_drop_pages);
+
+		if (until == dirty)
+			tiltyard_mark_clean(arena, beg, end);
+		if (beg <= top_dirty && top_dirty < end)
+			arena->top_dirty = end;
+		return;
+	}
+
+	for (TiltyardBlock *block = arena->block; block && end > beg; block = block->prev) {
+		size_t block_end = block->start + block->capacity;
+		size_t from = beg > block->start ? beg : block->start;
+		size_t until = end < block_end ? end : block_end;
+
+		if (from < until)
+			tiltyard_bulk_zero(tiltyard_block_data(block) + (from - block->start), until - from,
+					   arena->clean_threads, arena->clean_drop_pages);
+	}
+}
+
+/* Zeroes the 'size' bytes at 'ptr', found at 'start' in the arena, that
+ * may be dirty: the ones below 'dirty' and the ones at or above the
+ * arena's top_dirty.
+ *
+ * Returns:
+ * - Nothing.
+ */
+static void tiltyard_zero_span(Arena *arena, uint8_t *ptr, size_t start, size_t size, size_t dirty)
+{
+	size_t end = start + size;
+	size_t until = end < dirty ? end : dirty;
+	size_t from = start > arena->top_dirty ? start : arena->top_dirty;
+
+	if (start < until)
+		memset(ptr, 0, until - start);
+	if (from < until)
+		from = until;
+	if (from < end)
+		memset(ptr + (from - start), 0, end - from);
+}
+
+/* Zeroes the 'size' bytes of the last allocation of the arena at 'ptr'.
+ *
+ * The allocation starts at or above the offset the arena had before it
+ * was made, so only its bytes below the dirty_high_water, or that were
+ * allocated from the top end before, can be dirty.
+ *
+ * Returns:
+ * - Nothing.
+ */
+static void tiltyard_zero_allocation(Arena *arena, void *ptr, size_t size)
+{
+	tiltyard_zero_span(arena, ptr, arena->offset - size, size, arena->dirty_high_water);
+}
+
+/* Create a new arena with size 'capacity'.
+ *
+ * Create space in the heap for the arena
+ * through malloc, and for its base through calloc
+ *
+ * Returns:
+ * - A null pointer if the capacity is 0 or
+ *   there is not enough memory in the heap for that capacity or the arena pointer.
+ * - A pointer to a arena allocated in the heap if there is enough
+ *   memory in the heap for the capacity given.
+ *
+ * Notes:
+ * - Allocates memory in the heap 2 times, one for the arena
+ *   and the other one for the base of the arena (capacity).
+ * - The base starts zeroed, so 'tiltyard_calloc' does not zero it again.
+ *   Big bases are mapped directly by calloc, whose fresh pages are
+ *   already zero and cost nothing until they are touched.
+ * - The memory allocated in the heap for the arena and its base
+ *   must be freed through tiltyard_destroy, tiltyard_destroy_and_null, or
+ *   tiltyard_wipe_destroy_and_null functions.
+ */
+Arena *tiltyard_create(size_t capacity)
+{
+	if (capacity == 0)
+		tiltyard_handle_error(SIZE_EQUALS_ZERO, TILTYARD_CREATE, true);
+
+	Arena *arena = malloc(sizeof(Arena));
+	if (!arena) tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_ARENA, TILTYARD_CREATE, true);
+	
+	uint8_t *base = calloc(1, capacity);
+	if (!base) {
+		free(arena);
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_SIZE_OF_ARENA, TILTYARD_CREATE, true);
+		return NULL;
+	}
+
+	tiltyard_init(arena, TILTYARD_FIXED_ARENA, base, capacity);
+	return arena;
+}
+
+/* Create a new growable arena whose first block has 'block_capacity' bytes.
+ *
+ * When the current block of the arena is full, a new block is chained
+ * to it, each new block being twice as big as the previous one, until
+ * the sum of the capacities of all the blocks reaches 'max_capacity'.
+ *
+ * Returns:
+ * - A pointer to a growable arena allocated in the heap if there is enough
+ *   memory in the heap for the first block.
+ *
+ * Notes:
+ * - Allocates memory in the heap through malloc 2 times, one for the arena
+ *   and the other one for its first block.
+ * - Markers keep working across blocks: a marker is the sum of the capacities
+ *   of the previous blocks plus the offset inside of its block.
+ * - Blocks released by 'tiltyard_reset' and 'tiltyard_reset_to' are kept
+ *   in a cache and reused before calling malloc again, so an arena that
+ *   is reset and filled again up to the same size does not call malloc.
+ * - The memory allocated must be freed through tiltyard_destroy,
+ *   tiltyard_destroy_and_null, or tiltyard_wipe_destroy_and_null functions.
+ */
+Arena *tiltyard_create_growable(size_t block_capacity, size_t max_capacity)
+{
+	if (block_capacity == 0)
+		tiltyard_handle_error(SIZE_EQUALS_ZERO, TILTYARD_CREATE_GROWABLE, true);
+
+	if (max_capacity < block_capacity)
+		tiltyard_handle_error(INVALID_MAX_CAPACITY, TILTYARD_CREATE_GROWABLE, true);
+
+	Arena *arena = malloc(sizeof(Arena));
+	if (!arena) {
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_ARENA, TILTYARD_CREATE_GROWABLE, true);
+		return NULL;
+	}
+
+	TiltyardBlock *block = tiltyard_block_new(block_capacity);
+	if (!block) {
+		free(arena);
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_SIZE_OF_ARENA, TILTYARD_CREATE_GROWABLE, true);
+		return NULL;
+	}
+
+	tiltyard_init(arena, TILTYARD_GROWABLE_ARENA, NULL, 0);
+	arena->max_capacity = max_capacity;
+	tiltyard_use_block(arena, block);
+	return arena;
+}
+
+/* Create a new growable arena whose blocks come from 'pool'.
+ *
+ * Same behavior as 'tiltyard_create_growable' except:
+ * - Blocks are taken from 'pool' before calling malloc, and are
+ *   pushed back to 'pool' instead of being freed when the arena
+ *   is destroyed, or when it is reset past the first
+ *   TILTYARD_POOLED_CACHED_BLOCKS blocks of its block cache.
+ *
+ * Returns:
+ * - A pointer to a growable arena allocated in the heap if there is enough
+ *   memory in the heap for the arena and its first block.
+ *
+ * Notes:
+ * - The arena is aligned to a cache line, so arenas of different
+ *   threads never share one.
+ * - The arena itself is not thread-safe, only 'pool' is.
+ */
+Arena *tiltyard_create_pooled(TiltyardBlockPool *pool, size_t block_capacity, size_t max_capacity)
+{
+	if (block_capacity == 0)
+		tiltyard_handle_error(SIZE_EQUALS_ZERO, TILTYARD_CREATE_POOLED, true);
+
+	if (max_capacity < block_capacity)
+		tiltyard_handle_error(INVALID_MAX_CAPACITY, TILTYARD_CREATE_POOLED, true);
+
+	Arena *arena = aligned_alloc(64, size_round_up(sizeof(Arena), 64));
+	if (!arena) {
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_ARENA, TILTYARD_CREATE_POOLED, true);
+		return NULL;
+	}
+
+	TiltyardBlock *block = pool ? tiltyard_block_pool_pop(pool, block_capacity, max_capacity) : NULL;
+	if (!block) block = tiltyard_block_new(block_capacity);
+	if (!block) {
+		free(arena);
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_SIZE_OF_ARENA, TILTYARD_CREATE_POOLED, true);
+		return NULL;
+	}
+
+	tiltyard_init(arena, TILTYARD_GROWABLE_ARENA, NULL, 0);
+	arena->max_capacity = max_capacity;
+	arena->block_pool = pool;
+	block->prev = NULL;
+	block->start = 0;
+	tiltyard_use_block(arena, block);
+	return arena;
+}
+
+/* Create a new virtual arena that reserves 'reserve' bytes of address space.
+ *
+ * The address space is reserved through mmap without any access, and pages
+ * are committed through mprotect in multiples of 'commit_granule' bytes as
+ * the offset moves forward, so only the memory actually used is touched.
+ *
+ * Returns:
+ * - A pointer to a virtual arena allocated in the heap if the address
+ *   space could be reserved.
+ *
+ * Notes:
+ * - Allocates memory in the heap through malloc 1 time, for the arena.
+ * - 'reserve' and 'commit_granule' are rounded up to the page size, a
+ *   'commit_granule' of 0 commits one page at a time.
+ * - Unlike growable arenas, the memory of a virtual arena is contiguous,
+ *   so pointers into it stay valid while it grows.
+ * - The memory reserved must be released through tiltyard_destroy,
+ *   tiltyard_destroy_and_null, or tiltyard_wipe_destroy_and_null functions.
+ */
+Arena *tiltyard_create_virtual(size_t reserve, size_t commit_granule)
+{
+	if (reserve == 0)
+		tiltyard_handle_error(SIZE_EQUALS_ZERO, TILTYARD_CREATE_VIRTUAL, true);
+
+	size_t page_size = tiltyard_page_size();
+	reserve = size_round_up(reserve, page_size);
+	commit_granule = commit_granule == 0 ? page_size : size_round_up(commit_granule, page_size);
+
+	Arena *arena = malloc(sizeof(Arena));
+	if (!arena) {
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_ARENA, TILTYARD_CREATE_VIRTUAL, true);
+		return NULL;
+	}
+
+	void *base = mmap(NULL, reserve, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (base == MAP_FAILED) {
+		free(arena);
+		tiltyard_handle_error(VIRTUAL_MEMORY_RESERVE_FAILED, TILTYARD_CREATE_VIRTUAL, true);
+		return NULL;
+	}
+
+	tiltyard_init(arena, TILTYARD_VIRTUAL_ARENA, base, reserve);
+	arena->limit = 0;
+	arena->commit_granule = commit_granule;
+	return arena;
+}
+
+/* Faults in every page from 'base' to 'base' + 'size'.
+ *
+ * Asks the kernel to populate the pages through MADV_POPULATE_WRITE,
+ * and writes to one byte of every page when it is not supported.
+ *
+ * Returns:
+ * - Nothing.
+ */
+static void tiltyard_prefault(uint8_t *base, size_t size)
+{
+#ifdef MADV_POPULATE_WRITE
+	if (madvise(base, size, MADV_POPULATE_WRITE) == 0)
+		return;
+#endif
+
+	size_t page_size = tiltyard_page_size();
+	for (size_t i = 0; i < size; i += page_size)
+		((volatile uint8_t *)base)[i] = 0;
+}
+
+/* Returns the bytes of the 'size' bytes mapped at 'base' that are backed
+ * by transparent huge pages, read from the AnonHugePages of their mappings
+ * in /proc/self/smaps, or 0 if it can not be read.
+ */
+static size_t tiltyard_smaps_huge_pages(const uint8_t *base, size_t size)
+{
+	FILE *smaps = fopen("/proc/self/smaps", "r");
+	if (!smaps) return 0;
+
+	uintptr_t beg = (uintptr_t)base;
+	uintptr_t end = beg + size;
+	bool inside = false;
+	size_t huge_pages = 0;
+	char line[256];
+
+	while (fgets(line, sizeof(line), smaps)) {
+		uintptr_t map_beg, map_end;
+		size_t kilobytes;
+
+		if (sscanf(line, "%" SCNxPTR "-%" SCNxPTR " ", &map_beg, &map_end) == 2)
+			inside = map_beg < end && map_end > beg;
+		else if (inside && sscanf(line, "AnonHugePages: %zu kB", &kilobytes) == 1)
+			huge_pages += kilobytes * 1024;
+	}
+
+	fclose(smaps);
+	return huge_pages;
+}
+
+/* Maps the base of a fixed arena of at least 'capacity' bytes.
+ *
+ * With TILTYARD_CREATE_HUGE_PAGES the mapping is aligned to and sized in
+ * multiples of TILTYARD_HUGE_PAGE_SIZE and marked with MADV_HUGEPAGE, so
+ * the kernel can back it with transparent huge pages. With
+ * TILTYARD_CREATE_PREFAULT every page is faulted in before returning.
+ *
+ * Returns:
+ * - The base of the mapping, whose size is stored in 'mapped_size'.
+ * - NULL if the memory could not be mapped.
+ *
+ * Notes:
+ * - Falls back to normal pages when huge pages are not available,
+ *   so asking for them never makes the creation fail.
+ * - Whether huge pages were obtained is stored in 'huge_pages': on
+ *   prefaulted mappings /proc/self/smaps is read once to check the kernel
+ *   backed them with huge pages, otherwise it is whether madvise succeeded.
+ */
+static uint8_t *tiltyard_map_base(size_t capacity, unsigned options, size_t *mapped_size, bool *huge_pages)
+{
+	*huge_pages = false;
+
+	size_t size = size_round_up(capacity, tiltyard_page_size());
+	if (size == SIZE_MAX) return NULL;
+
+	if (options & TILTYARD_CREATE_HUGE_PAGES) {
+		size_t huge_size = size_round_up(capacity, TILTYARD_HUGE_PAGE_SIZE);
+		uint8_t *raw = MAP_FAILED;
+
+		if (huge_size != SIZE_MAX && !size_add_overflow(huge_size, TILTYARD_HUGE_PAGE_SIZE))
+			raw = mmap(NULL, huge_size + TILTYARD_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+				   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		if (raw != MAP_FAILED) {
+			uint8_t *base = (uint8_t *)(((uintptr_t)raw + TILTYARD_HUGE_PAGE_SIZE - 1) &
+						   ~(uintptr_t)(TILTYARD_HUGE_PAGE_SIZE - 1));
+			size_t head = (size_t)(base - raw);
+
+			if (head) munmap(raw, head);
+			if (TILTYARD_HUGE_PAGE_SIZE - head) munmap(base + huge_size, TILTYARD_HUGE_PAGE_SIZE - head);
+#ifdef MADV_HUGEPAGE
+			*huge_pages = madvise(base, huge_size, MADV_HUGEPAGE) == 0;
+#endif
+			if (options & TILTYARD_CREATE_PREFAULT) {
+				tiltyard_prefault(base, huge_size);
+				if (*huge_pages)
+					*huge_pages = tiltyard_smaps_huge_pages(base, huge_size) > 0;
+			}
+
+			*mapped_size = huge_size;
+			return base;
+		}
+	}
+
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+	if (options & TILTYARD_CREATE_PREFAULT)
+		flags |= MAP_POPULATE;
+
+	void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+	if (base == MAP_FAILED) return NULL;
+
+	*mapped_size = size;
+	return base;
+}
+
+/* Create a new arena of at least 'capacity' bytes with the given creation options.
+ *
+ * Same behavior as 'tiltyard_create' except:
+ * - The base is mapped through mmap instead of calloc, and its capacity
+ *   is rounded up to a multiple of the page size.
+ * - With TILTYARD_CREATE_PREFAULT every page of the base is faulted in
+ *   by the creation (MAP_POPULATE), so the first touch of a page never
+ *   faults afterwards.
+ * - With TILTYARD_CREATE_HUGE_PAGES the base is aligned to 2 MB, its
+ *   capacity is rounded up to a multiple of 2 MB and it is marked with
+ *   madvise(MADV_HUGEPAGE).
+ *
+ * Returns:
+ * - A pointer to an arena allocated in the heap if there is enough
+ *   memory for the arena and its base.
+ *
+ * Notes:
+ * - Whether the kernel gave huge pages is reported by the stats, see
+ *   'tiltyard_get_huge_pages_obtained', and how many bytes are backed by
+ *   them by 'tiltyard_get_huge_pages', the arena works with normal pages
+ *   when transparent huge pages are disabled or not available.
+ * - Decommitting pages of the arena (see 'tiltyard_set_decommit')
+ *   may split its huge pages.
+ */
+Arena *tiltyard_create_with_options(size_t capacity, unsigned options)
+{
+	if (capacity == 0) {
+		tiltyard_handle_error(SIZE_EQUALS_ZERO, TILTYARD_CREATE_WITH_OPTIONS, true);
+		return NULL;
+	}
+
+	Arena *arena = malloc(sizeof(Arena));
+	if (!arena) {
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_ARENA, TILTYARD_CREATE_WITH_OPTIONS, true);
+		return NULL;
+	}
+
+	size_t mapped_size = 0;
+	bool huge_pages;
+	uint8_t *base = tiltyard_map_base(capacity, options, &mapped_size, &huge_pages);
+	if (!base) {
+		free(arena);
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_SIZE_OF_ARENA, TILTYARD_CREATE_WITH_OPTIONS, true);
+		return NULL;
+	}
+
+	tiltyard_init(arena, TILTYARD_FIXED_ARENA, base, mapped_size);
+	arena->mapped_size = mapped_size;
+	arena->create_options = options;
+	arena->huge_pages = huge_pages;
+	return arena;
+}
+
+/* Initialize 'arena' as a fixed arena over the 'capacity' bytes at 'buffer'.
+ *
+ * Neither the arena nor its memory are allocated, so arenas can live
+ * on the stack or in static memory without calling malloc.
+ *
+ * Returns:
+ * - 'arena' if 'arena' and 'buffer' are not NULL and 'capacity' is not 0.
+ *
+ * Notes:
+ * - tiltyard_destroy does not free 'arena' nor 'buffer', both stay
+ *   owned by the caller and must outlive the arena.
+ * - The contents of 'buffer' are unknown, so 'tiltyard_calloc' zeroes
+ *   all of it until the buffer is wiped.
+ * - Pages of 'buffer' are never released to the OS, since it may be
+ *   a mapping that does not read as zero afterwards, so
+ *   'tiltyard_set_decommit' and the 'drop_pages' option of
+ *   'tiltyard_set_clean' are not supported.
+ */
+Arena *tiltyard_init_buffer(Arena *arena, void *buffer, size_t capacity)
+{
+	if (!arena || !buffer) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_INIT_BUFFER, true);
+		return NULL;
+	}
+
+	if (capacity == 0) {
+		tiltyard_handle_error(SIZE_EQUALS_ZERO, TILTYARD_INIT_BUFFER, true);
+		return NULL;
+	}
+
+	tiltyard_init(arena, TILTYARD_FIXED_ARENA, buffer, capacity);
+	arena->dirty_high_water = capacity;
+	arena->owns_base = false;
+	arena->owns_header = false;
+	arena->borrowed = true;
+	return arena;
+}
+
+/* Create a new arena inside of the 'size' bytes at 'buffer'.
+ *
+ * Same behavior as 'tiltyard_init_buffer' except:
+ * - The arena itself is placed at the beginning of 'buffer', and
+ *   its memory is the rest of the buffer.
+ *
+ * Returns:
+ * - A pointer to the arena, inside of 'buffer'.
+ * - NULL if 'buffer' is NULL or too small for the arena and one byte.
+ *
+ * Notes:
+ * - 'buffer' must be aligned to at least TILTYARD_ALIGNOF(Arena).
+ */
+Arena *tiltyard_create_in_buffer(void *buffer, size_t size)
+{
+	if (!buffer) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_CREATE_IN_BUFFER, true);
+		return NULL;
+	}
+
+	if ((uintptr_t)buffer % TILTYARD_ALIGNOF(Arena) != 0) {
+		tiltyard_handle_error(INVALID_ALIGNMENT, TILTYARD_CREATE_IN_BUFFER, true);
+		return NULL;
+	}
+
+	if (size <= TILTYARD_ARENA_HEADER_SIZE) {
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_ARENA, TILTYARD_CREATE_IN_BUFFER, true);
+		return NULL;
+	}
+
+	Arena *arena = buffer;
+	return tiltyard_init_buffer(arena, (uint8_t *)buffer + TILTYARD_ARENA_HEADER_SIZE,
+				    size - TILTYARD_ARENA_HEADER_SIZE);
+}
+
+/* Create a new arena of 'capacity' bytes carved out of 'parent'.
+ *
+ * The child arena and its memory are allocated from 'parent', and
+ * are given back to it when the child is destroyed, as long as nothing
+ * was allocated from 'parent' after the child since then.
+ *
+ * Returns:
+ * - A pointer to the child arena, inside of the parent's memory.
+ * - NULL if 'parent' is NULL or does not have room for the child.
+ *
+ * Notes:
+ * - Does NOT call malloc/free.
+ * - Children must be destroyed in the reverse order they were created
+ *   for their memory to go back to the parent right away, otherwise it
+ *   is reclaimed when the parent is reset below them.
+ * - Resetting or destroying the parent below a child invalidates the child.
+ * - The child keeps the clean settings of the parent, and the memory
+ *   the parent knows to be zero is known to be zero by the child.
+ */
+Arena *tiltyard_create_sub(Arena *parent, size_t capacity)
+{
+	if (!parent) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_CREATE_SUB, true);
+		return NULL;
+	}
+
+	if (capacity == 0) {
+		tiltyard_handle_error(SIZE_EQUALS_ZERO, TILTYARD_CREATE_SUB, true);
+		return NULL;
+	}
+
+	if (size_add_overflow(TILTYARD_ARENA_HEADER_SIZE, capacity)) {
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_SIZE_OF_ARENA, TILTYARD_CREATE_SUB, true);
+		return NULL;
+	}
+
+	size_t marker = parent->offset;
+	uint8_t *memory = tiltyard_alloc_quiet(parent, TILTYARD_ARENA_HEADER_SIZE + capacity, 16);
+	if (!memory) {
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_SIZE_OF_ARENA, TILTYARD_CREATE_SUB, true);
+		return NULL;
+	}
+
+	Arena *arena = (Arena *)(void *)memory;
+	tiltyard_init(arena, TILTYARD_FIXED_ARENA, memory + TILTYARD_ARENA_HEADER_SIZE, capacity);
+
+	/* Bytes of the child above the parent's dirty mark are zero. */
+	size_t start = parent->offset - capacity;
+	size_t dirty = parent->kind == TILTYARD_GROWABLE_ARENA ? SIZE_MAX : parent->dirty_high_water;
+	arena->dirty_high_water = dirty <= start ? 0 : (dirty - start < capacity ? dirty - start : capacity);
+	arena->top_dirty = parent->top_dirty <= start ? 0 :
+			   (parent->top_dirty - start < capacity ? parent->top_dirty - start : capacity);
+
+	arena->clean_threads = parent->clean_threads;
+	arena->clean_drop_pages = parent->clean_drop_pages;
+	arena->parent = parent;
+	arena->parent_marker = marker;
+	arena->parent_end = parent->offset;
+	arena->owns_base = false;
+	arena->owns_header = false;
+	arena->borrowed = parent->borrowed;
+	return arena;
+}
+
+/* Records 'large', whose memory starts at 'data', in the arena's
+ * list of large allocations.
+ *
+ * The arena's offset before the allocation is recorded as its marker, so
+ * resetting the arena to a marker taken before the allocation always frees
+ * it, whether the arena had room left or not. A byte of the arena is also
+ * allocated along with it when the arena has room for it, so a marker taken
+ * after the allocation is past its marker and keeps it.
+ *
+ * Returns:
+ * - A pointer to the memory of the allocation.
+ *
+ * Notes:
+ * - Without room for the byte, the arena's last allocation is cleared,
+ *   so 'tiltyard_free_last' does not free the allocation before it.
+ */
+static void *tiltyard_push_large(Arena *arena, TiltyardLargeAlloc *large, uint8_t *data, size_t mapped_size,
+				 bool heap)
+{
+	size_t marker = arena->offset;
+	if (!tiltyard_alloc_quiet(arena, 1, 1))
+		arena->last_alloc_offset = arena->offset;
+
+	large->prev = arena->large_allocs;
+	large->data = data;
+	large->mapped_size = mapped_size;
+	large->marker = marker;
+	large->heap = heap;
+
+	arena->large_allocs = large;
+	arena->large_count++;
+	arena->large_bytes += mapped_size;
+	return data;
+}
+
+/* Returns the bytes needed to hold a large allocation of 'size' bytes
+ * aligned to 'alignment' after its header, or SIZE_MAX if they overflow.
+ */
+static size_t tiltyard_large_size(size_t size, size_t alignment)
+{
+	if (size_add_overflow(sizeof(TiltyardLargeAlloc), alignment - 1) ||
+	    size_add_overflow(sizeof(TiltyardLargeAlloc) + alignment - 1, size))
+		return SIZE_MAX;
+
+	return sizeof(TiltyardLargeAlloc) + alignment - 1 + size;
+}
+
+/* Returns the first address after the header at 'header' aligned to 'alignment'. */
+static uint8_t *tiltyard_large_data(void *header, size_t alignment)
+{
+	uintptr_t data = (uintptr_t)header + sizeof(TiltyardLargeAlloc);
+
+	return (uint8_t *)((data + alignment - 1) & ~(uintptr_t)(alignment - 1));
+}
+
+/* Gives 'size' bytes aligned to 'alignment' their own mapping,
+ * recorded in the arena's list of large allocations.
+ *
+ * Returns:
+ * - A pointer to the memory of the mapping, which is zeroed.
+ * - NULL if the mapping could not be made.
+ */
+static void *tiltyard_alloc_large(Arena *arena, size_t size, size_t alignment,
+				  enum tiltyard_overflow_policy policy)
+{
+	size_t mapped_size = size_round_up(tiltyard_large_size(size, alignment), tiltyard_page_size());
+
+	if (mapped_size == SIZE_MAX) {
+		tiltyard_report_overflow(policy, EXCEEDED_ARENA_CAPACITY, TILTYARD_ALLOC_ALIGNED);
+		return NULL;
+	}
+
+	uint8_t *map = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (map == MAP_FAILED) {
+		tiltyard_report_overflow(policy, VIRTUAL_MEMORY_RESERVE_FAILED, TILTYARD_ALLOC_ALIGNED);
+		return NULL;
+	}
+
+	return tiltyard_push_large(arena, (TiltyardLargeAlloc *)(void *)map, tiltyard_large_data(map, alignment),
+				   mapped_size, false);
+}
+
+/* Gives 'size' bytes aligned to 'alignment' a block of the heap,
+ * recorded in the arena's list of large allocations.
+ *
+ * Returns:
+ * - A pointer to the memory of the block, which is uninitialized.
+ * - NULL if there is not enough memory in the heap.
+ */
+static void *tiltyard_alloc_heap(Arena *arena, size_t size, size_t alignment)
+{
+	size_t heap_size = tiltyard_large_size(size, alignment);
+	void *block = heap_size == SIZE_MAX ? NULL : malloc(heap_size);
+
+	if (!block)
+		return NULL;
+
+	return tiltyard_push_large(arena, block, tiltyard_large_data(block, alignment), heap_size, true);
+}
+
+/* Frees the large allocation 'link' points to and removes it from the list.
+ *
+ * Returns:
+ * - Nothing.
+ */
+static void tiltyard_unmap_large(Arena *arena, TiltyardLargeAlloc **link)
+{
+	TiltyardLargeAlloc *large = *link;
+
+	*link = large->prev;
+	arena->large_count--;
+	arena->large_bytes -= large->mapped_size;
+
+	if (large->heap)
+		free(large);
+	else
+		munmap(large, large->mapped_size);
+}
+
+/* Frees every large allocation made after 'marker' was taken.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - On a full arena, a marker taken after a large allocation equals its
+ *   marker, so it frees it too.
+ */
+static void tiltyard_release_large(Arena *arena, size_t marker)
+{
+	while (arena->large_allocs && arena->large_allocs->marker >= marker)
+		tiltyard_unmap_large(arena, &arena->large_allocs);
+}
+
+/* Frees every large allocation of the arena.
+ *
+ * Returns:
+ * - Nothing.
+ */
+static void tiltyard_release_all_large(Arena *arena)
+{
+	while (arena->large_allocs)
+		tiltyard_unmap_large(arena, &arena->large_allocs);
+}
+
+/* Finds the large allocation whose memory starts at 'ptr'.
+ *
+ * Returns:
+ * - The link of the list pointing to it.
+ * - NULL if 'ptr' is not a large allocation of the arena.
+ */
+static TiltyardLargeAlloc **tiltyard_find_large(Arena *arena, const void *ptr)
+{
+	for (TiltyardLargeAlloc **link = &arena->large_allocs; *link; link = &(*link)->prev) {
+		if ((*link)->data == ptr)
+			return link;
+	}
+
+	return NULL;
+}
+
+/* Resizes the large allocation 'link' points to to 'new_size' bytes.
+ *
+ * Mappings are resized through mremap, which moves their pages instead
+ * of copying them when they cannot grow in place. Heap blocks, and mappings
+ * aligned to more than a page, are moved to a new allocation.
+ *
+ * Returns:
+ * - A pointer to the resized memory.
+ * - NULL if 'new_size' is 0, the allocation is freed.
+ * - NULL if the allocation could not be resized, the old one is kept.
+ */
+static void *tiltyard_realloc_large(Arena *arena, TiltyardLargeAlloc **link, size_t old_size, size_t new_size,
+				    size_t alignment)
+{
+	TiltyardLargeAlloc *large = *link;
+	size_t page_size = tiltyard_page_size();
+	size_t data_offset = (size_t)(large->data - (uint8_t *)large);
+
+	if (new_size == 0) {
+		tiltyard_unmap_large(arena, link);
+		return NULL;
+	}
+
+	/* A moved mapping is only page aligned. */
+	if (large->heap || alignment > page_size) {
+		if (new_size <= old_size)
+			return large->data;
+
+		void *moved = tiltyard_alloc_aligned(arena, new_size, alignment);
+		if (!moved) return NULL;
+
+		memcpy(moved, large->data, old_size);
+
+		/* The new allocation may have been pushed in front of it. */
+		link = tiltyard_find_large(arena, large->data);
+		if (link) tiltyard_unmap_large(arena, link);
+		return moved;
+	}
+
+	size_t mapped_size = size_add_overflow(data_offset, new_size) ? SIZE_MAX :
+			     size_round_up(data_offset + new_size, page_size);
+	if (mapped_size == SIZE_MAX) {
+		tiltyard_report_overflow(arena->overflow_policy, EXCEEDED_ARENA_CAPACITY, TILTYARD_REALLOC_ALIGNED);
+		return NULL;
+	}
+
+	if (mapped_size == large->mapped_size)
+		return large->data;
+
+	uint8_t *map = mremap(large, large->mapped_size, mapped_size, MREMAP_MAYMOVE);
+	if (map == MAP_FAILED) {
+		tiltyard_report_overflow(arena->overflow_policy, VIRTUAL_MEMORY_COMMIT_FAILED, TILTYARD_REALLOC_ALIGNED);
+		return NULL;
+	}
+
+	large = (TiltyardLargeAlloc *)(void *)map;
+	arena->large_bytes = arena->large_bytes - large->mapped_size + mapped_size;
+	large->data = map + data_offset;
+	large->mapped_size = mapped_size;
+	*link = large;
+	return large->data;
+}
+
+/* Handles an allocation of 'size' bytes aligned to 'alignment'
+ * that does not fit in the arena, following 'policy'.
+ *
+ * Returns:
+ * - A pointer to memory from the arena's fallback arena, the heap,
+ *   a mapping of its own or the arena's callback, depending on the policy.
+ * - NULL if the policy is TILTYARD_OVERFLOW_NULL or the memory
+ *   could not be found elsewhere either.
+ */
+__attribute__((cold, noinline))
+static void *tiltyard_overflow(Arena *arena, size_t size, size_t alignment,
+				enum tiltyard_overflow_policy policy)
+{
+	void *ptr = NULL;
+
+	switch (policy) {
+	case TILTYARD_OVERFLOW_FALLBACK:
+		ptr = tiltyard_alloc_aligned(arena->overflow_fallback, size, alignment);
+		break;
+
+	case TILTYARD_OVERFLOW_HEAP:
+		ptr = tiltyard_alloc_heap(arena, size, alignment);
+		break;
+
+	case TILTYARD_OVERFLOW_GROW:
+		ptr = tiltyard_alloc_large(arena, size, alignment, policy);
+		break;
+
+	case TILTYARD_OVERFLOW_CALLBACK:
+		ptr = arena->overflow_callback(arena, size, alignment, arena->overflow_user);
+		break;
+
+	default:
+		break;
+	}
+
+	if (ptr) arena->overflow_count++;
+	return ptr;
+}
+
+/* Zeroes the 'size' bytes at 'ptr' allocated by a calloc of the arena.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Allocations from the arena's memory end at its offset, and only their
+ *   bytes below the dirty mark are zeroed. Fresh mappings are already zero.
+ */
+static void tiltyard_zero_result(Arena *arena, void *ptr, size_t size)
+{
+	uint8_t *cursor = arena->base + (arena->offset - arena->block_start);
+
+	if ((uint8_t *)ptr + size == cursor) {
+		tiltyard_zero_allocation(arena, ptr, size);
+		return;
+	}
+
+	TiltyardLargeAlloc *large = arena->large_allocs;
+	if (large && large->data == ptr && !large->heap)
+		return;
+
+	memset(ptr, 0, size);
+}
+
+/* Allocate 'size' bytes from the arena with the default alignment
+ *
+ * The default alignment is sizeof(void *).
+ *
+ * Returns:
+ * - A pointer into the arena if there is enough capacity.
+ * - NULL if there is not enough space or arena == NULL.
+ *
+ * Notes:
+ * - Does NOT call malloc/free; the returned pointer comes
+ *   from the already allocated memory for the arena.
+ * - The memory is uninitialized (use tiltyard_calloc if you need
+ *   zeroed memory)
+ * - When the arena is full its overflow policy applies, which by
+ *   default aborts, see 'tiltyard_set_overflow'.
+ */
+void *tiltyard_alloc(Arena *arena, size_t size)
+{
+	if (!arena)
+		return tiltyard_alloc_slow(arena, size, sizeof(void *));
+
+	if (size >= arena->large_threshold)
+		return tiltyard_alloc_large(arena, size, sizeof(void *), arena->overflow_policy);
+
+	return tiltyard_alloc_inline(arena, size, sizeof(void *));
+}
+
+/* Allocate size bytes from the arena with the default alignment,
+ * and zero-initialize the memory.
+ *
+ * Same behavior as 'tiltyard_alloc' except:
+ * - The returned memory is set to all zero bytes.
+ *
+ * Returns:
+ * - A pointer into the arena if there is enough capacity.
+ * - NULL if there is not enough space or arena == NULL.
+ *
+ * Notes:
+ * - Does NOT call malloc/free; the returned pointer comes
+ *   from the already allocated memory for the arena.
+ * - Only the bytes below the arena's dirty mark are zeroed, the memory
+ *   above it was never written since it was mapped or last cleaned.
+ */
+void *tiltyard_calloc(Arena *arena, size_t size)
+{
+	void *ptr = tiltyard_alloc(arena, size);
+
+	if (ptr)
+		tiltyard_zero_result(arena, ptr, size);
+
+	return ptr;
+}
+
+/* Allocate size bytes from the arena with a custom alignment.
+ *
+ * Same behavior as 'tiltyard_alloc' except:
+ * - The memory is aligned based on 'alignment' instead of a
+ *   default one.
+ *
+ * This function also assign stats such as last_alloc, alloc_count,
+ * and high_water to the arena for each allocation.
+ *
+ * The alignment applies to the returned address, not to the offset,
+ * so alignments bigger than the one given by malloc are also honored.
+ *
+ * Returns:
+ * - A pointer into the arena if there is enough capacity.
+ * - NULL if there is not enough space or arena == NULL.
+ *
+ * Notes:
+ * - Does NOT call malloc/free; the returned pointer comes
+ *   from the already allocated memory for the arena.
+ * - The memory is uninitialized (use tiltyard_calloc_aligned if you need
+ *   zeroed memory)
+ * - On growable arenas a new block is chained when the current one is full.
+ * - On virtual arenas more pages are committed when the allocation goes
+ *   past the committed watermark.
+ * - The allocation itself is done by 'tiltyard_alloc_inline', which
+ *   can also be called directly to avoid this call.
+ * - When the arena is full its overflow policy applies, see 'tiltyard_set_overflow'.
+ */
+void *tiltyard_alloc_aligned(Arena *arena, size_t size, size_t alignment)
+{
+	if (!arena || alignment == 0 || (alignment & (alignment - 1)) != 0)
+		return tiltyard_alloc_slow(arena, size, alignment);
+
+	if (size >= arena->large_threshold)
+		return tiltyard_alloc_large(arena, size, alignment, arena->overflow_policy);
+
+	return tiltyard_alloc_inline(arena, size, alignment);
+}
+
+/* Slow path of the allocations of 'tiltyard_alloc_inline'.
+ *
+ * Checks the arena and the alignment, reporting the errors found,
+ * gives the allocation its own mapping when it is above the arena's
+ * large threshold and otherwise makes room for it below the arena's limit.
+ *
+ * Returns:
+ * - A pointer into the arena if there is enough capacity.
+ * - NULL if there is not enough space or arena == NULL.
+ *
+ * Notes:
+ * - Kept out of line and marked as cold, so the fast path
+ *   inlined in the callers stays small.
+ */
+__attribute__((cold, noinline))
+void *tiltyard_alloc_slow(Arena *arena, size_t size, size_t alignment)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_ALLOC_ALIGNED, true);
+		return NULL;
+	}
+
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+		tiltyard_handle_error(INVALID_ALIGNMENT, TILTYARD_ALLOC_ALIGNED, true);
+		return NULL;
+	}
+
+	if (size >= arena->large_threshold)
+		return tiltyard_alloc_large(arena, size, alignment, arena->overflow_policy);
+
+	return tiltyard_alloc_policy(arena, size, alignment, arena->overflow_policy);
+}
+
+/* Allocate 'size' bytes aligned to 'alignment' from the arena, making room
+ * for them when they do not fit below the arena's limit, and following
+ * 'policy' instead of the arena's overflow policy when there is no room.
+ *
+ * Returns:
+ * - A pointer into the arena if there is enough capacity.
+ * - Memory found by 'policy' if there is not.
+ * - NULL if there is not enough space anywhere.
+ *
+ * Notes:
+ * - 'arena' must not be NULL and 'alignment' must be a power of two.
+ */
+static void *tiltyard_alloc_policy(Arena *arena, size_t size, size_t alignment,
+				   enum tiltyard_overflow_policy policy)
+{
+	uint8_t *cursor = arena->base + (arena->offset - arena->block_start);
+	size_t padding = (size_t)(-(uintptr_t)cursor & (alignment - 1));
+
+	if (size_add_overflow(padding, size) || padding + size > arena->limit - arena->offset) {
+		if (!tiltyard_make_room(arena, size, alignment, padding, policy))
+			return tiltyard_overflow(arena, size, alignment, policy);
+	}
+
+	return tiltyard_alloc_inline(arena, size, alignment);
+}
+
+/* Allocate size bytes from the arena with a custom alignment,
+ * and zero-initialize the memory.
+ *
+ * Same behavior as 'tiltyard_calloc' except:
+ * - The memory is aligned based on 'alignment' instead of a
+ *   default one.
+ *
+ * Returns:
+ * - A pointer into the arena if there is enough capacity.
+ * - NULL if there is not enough space or arena == NULL.
+ *
+ * Notes:
+ * - Does NOT call malloc/free; the returned pointer comes
+ *   from the already allocated memory for the arena.
+ * - Only the bytes below the arena's dirty mark are zeroed, see
+ *   'tiltyard_calloc'.
+ */
+void *tiltyard_calloc_aligned(Arena *arena, size_t size, size_t alignment)
+{
+	void *ptr = tiltyard_alloc_aligned(arena, size, alignment);
+
+	if (ptr)
+		tiltyard_zero_result(arena, ptr, size);
+
+	return ptr;
+}
+
+/* Allocate 'size' bytes from the arena with the default alignment,
+ * returning NULL instead of aborting when the arena is full.
+ *
+ * Same behavior as 'tiltyard_try_alloc_aligned' with the default
+ * alignment (sizeof(void *)).
+ */
+void *tiltyard_try_alloc(Arena *arena, size_t size)
+{
+	return tiltyard_try_alloc_aligned(arena, size, sizeof(void *));
+}
+
+/* Allocate 'size' bytes from the arena with the default alignment and
+ * zero-initialize them, returning NULL instead of aborting when the arena is full.
+ *
+ * Same behavior as 'tiltyard_try_calloc_aligned' with the default
+ * alignment (sizeof(void *)).
+ */
+void *tiltyard_try_calloc(Arena *arena, size_t size)
+{
+	return tiltyard_try_calloc_aligned(arena, size, sizeof(void *));
+}
+
+/* Allocate 'size' bytes from the arena with a custom alignment,
+ * returning NULL instead of aborting when the arena is full.
+ *
+ * Same behavior as 'tiltyard_alloc_aligned' except:
+ * - An arena whose overflow policy is TILTYARD_OVERFLOW_ABORT behaves
+ *   as if it was TILTYARD_OVERFLOW_NULL, every other policy applies.
+ *
+ * Returns:
+ * - A pointer into the arena if there is enough capacity.
+ * - Memory from the arena's overflow policy if there is not.
+ * - NULL if there is not enough space anywhere.
+ *
+ * Notes:
+ * - A NULL 'arena' or an invalid 'alignment' are still reported
+ *   as errors, they are bugs rather than the arena being full.
+ * - The failure path does not print anything.
+ */
+void *tiltyard_try_alloc_aligned(Arena *arena, size_t size, size_t alignment)
+{
+	if (!arena || alignment == 0 || (alignment & (alignment - 1)) != 0)
+		return tiltyard_alloc_slow(arena, size, alignment);
+
+	enum tiltyard_overflow_policy policy = arena->overflow_policy;
+	if (policy == TILTYARD_OVERFLOW_ABORT)
+		policy = TILTYARD_OVERFLOW_NULL;
+
+	if (size >= arena->large_threshold)
+		return tiltyard_alloc_large(arena, size, alignment, policy);
+
+	return tiltyard_alloc_policy(arena, size, alignment, policy);
+}
+
+/* Allocate 'size' bytes from the arena with a custom alignment and
+ * zero-initialize them, returning NULL instead of aborting when the arena is full.
+ *
+ * Same behavior as 'tiltyard_try_alloc_aligned' except:
+ * - The returned memory is set to all zero bytes.
+ */
+void *tiltyard_try_calloc_aligned(Arena *arena, size_t size, size_t alignment)
+{
+	void *ptr = tiltyard_try_alloc_aligned(arena, size, alignment);
+
+	if (ptr)
+		tiltyard_zero_result(arena, ptr, size);
+
+	return ptr;
+}
+
+/* Resizes the allocation at 'ptr' from 'old_size' to 'new_size' bytes
+ * with the default alignment.
+ *
+ * Same behavior as 'tiltyard_realloc_aligned' with the default
+ * alignment (sizeof(void *)).
+ */
+void *tiltyard_realloc(Arena *arena, void *ptr, size_t old_size, size_t new_size)
+{
+	return tiltyard_realloc_aligned(arena, ptr, old_size, new_size, sizeof(void *));
+}
+
+/* Resizes the allocation at 'ptr' from 'old_size' to 'new_size' bytes.
+ *
+ * If 'ptr' is the last allocation of the arena (it ends at the current
+ * offset), it grows or shrinks in place by moving the offset, without
+ * copying anything. Otherwise, a new allocation aligned to 'alignment'
+ * is made and the first 'old_size' bytes are copied to it.
+ *
+ * Returns:
+ * - 'ptr' if the allocation was resized in place.
+ * - A pointer to the new allocation if it was moved.
+ * - NULL if there is not enough space or arena == NULL.
+ *
+ * Notes:
+ * - A NULL 'ptr' behaves like 'tiltyard_alloc_aligned'.
+ * - Shrinking an allocation that is not the last one
+ *   returns 'ptr' without changing the arena.
+ * - The bytes added by growing the allocation are uninitialized.
+ * - Virtual arenas commit the pages needed to grow in place, growable
+ *   arenas move the allocation to a new block when the current one is full.
+ * - Large allocations are resized through mremap, and unmapped when
+ *   'new_size' is 0, see 'tiltyard_set_large_threshold'. Allocations
+ *   that grow above the threshold are moved to their own mapping.
+ */
+void *tiltyard_realloc_aligned(Arena *arena, void *ptr, size_t old_size, size_t new_size, size_t alignment)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_REALLOC_ALIGNED, true);
+		return NULL;
+	}
+
+	if (!ptr)
+		return tiltyard_alloc_aligned(arena, new_size, alignment);
+
+	uint8_t *cursor = arena->base + (arena->offset - arena->block_start);
+	bool is_last = (uint8_t *)ptr + old_size == cursor;
+
+	if (!is_last && arena->large_allocs) {
+		TiltyardLargeAlloc **link = tiltyard_find_large(arena, ptr);
+		if (link) return tiltyard_realloc_large(arena, link, old_size, new_size, alignment);
+	}
+
+	if (new_size <= old_size) {
+		if (is_last) {
+			tiltyard_mark_dirty(arena);
+			arena->offset -= old_size - new_size;
+		}
+		return ptr;
+	}
+
+	size_t grow = new_size - old_size;
+	if (is_last && new_size < arena->large_threshold) {
+		if (grow > arena->limit - arena->offset && arena->kind != TILTYARD_GROWABLE_ARENA &&
+		    grow <= arena->top - arena->offset)
+			tiltyard_make_room(arena, grow, 1, 0, arena->overflow_policy);
+
+		if (grow <= arena->limit - arena->offset) {
+			arena->offset += grow;
+#if TILTYARD_STATS
+			if (arena->offset > arena->high_water)
+				arena->high_water = arena->offset;
+#endif
+			return ptr;
+		}
+	}
+
+	void *moved = tiltyard_alloc_aligned(arena, new_size, alignment);
+	if (!moved) return NULL;
+
+	memcpy(moved, ptr, old_size);
+	return moved;
+}
+
+/* Frees the last allocation of the arena.
+ *
+ * Moves the offset back to where it was before the last allocation,
+ * if the arena's offset did not go below it since then.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Only the last allocation can be freed, calling this function
+ *   twice in a row frees nothing the second time.
+ * - The arena will conserve the data it had before.
+ * - A last allocation that has its own mapping is unmapped, unless it
+ *   was made while the arena was full: it then takes no byte of the
+ *   arena, nothing is freed, and it stays until the arena is reset
+ *   below it, see 'tiltyard_set_large_threshold'.
+ */
+void tiltyard_free_last(Arena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_FREE_LAST, true);
+		return;
+	}
+
+	if (arena->last_alloc_offset >= arena->offset || arena->last_alloc_offset < arena->block_start)
+		return;
+
+	tiltyard_release_large(arena, arena->last_alloc_offset);
+	tiltyard_mark_dirty(arena);
+	arena->offset = arena->last_alloc_offset;
+}
+
+/* Allocate 'size' bytes from the top end of the arena with the default alignment
+ *
+ * Same behavior as 'tiltyard_alloc_top_aligned' with the default
+ * alignment (sizeof(void *)).
+ */
+void *tiltyard_alloc_top(Arena *arena, size_t size)
+{
+	return tiltyard_alloc_top_aligned(arena, size, sizeof(void *));
+}
+
+/* Allocate 'size' bytes from the top end of the arena with a custom alignment.
+ *
+ * Every arena has a second bump pointer, its top, that starts at the
+ * capacity and moves down, so long-lived and short-lived allocations can
+ * share the same memory without the short-lived ones getting stuck under
+ * the long-lived ones. Allocations of both ends fail once they meet.
+ *
+ * Returns:
+ * - A pointer into the arena if there is enough space between both ends.
+ * - NULL if there is not enough space or arena == NULL.
+ *
+ * Notes:
+ * - Only fixed arenas can allocate from the top end, since it is the
+ *   only kind whose whole capacity is backed by memory from the start.
+ * - The top end has its own marker and reset, see 'tiltyard_get_top_marker'
+ *   and 'tiltyard_reset_top_to', and does not change 'last_alloc_offset'.
+ * - The memory is uninitialized (use tiltyard_calloc_top if you need
+ *   zeroed memory)
+ */
+void *tiltyard_alloc_top_aligned(Arena *arena, size_t size, size_t alignment)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_ALLOC_TOP_ALIGNED, true);
+		return NULL;
+	}
+
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+		tiltyard_handle_error(INVALID_ALIGNMENT, TILTYARD_ALLOC_TOP_ALIGNED, true);
+		return NULL;
+	}
+
+	if (arena->kind != TILTYARD_FIXED_ARENA) {
+		tiltyard_handle_error(UNSUPPORTED_ARENA_KIND, TILTYARD_ALLOC_TOP_ALIGNED, true);
+		return NULL;
+	}
+
+	uintptr_t bottom = (uintptr_t)arena->base + arena->offset;
+	uintptr_t top = (uintptr_t)arena->base + arena->top;
+	uintptr_t start = (top - size) & ~(uintptr_t)(alignment - 1);
+
+	if (size > top - bottom || start < bottom) {
+		tiltyard_report_overflow(arena->overflow_policy, EXCEEDED_ARENA_CAPACITY, TILTYARD_ALLOC_TOP_ALIGNED);
+		return NULL;
+	}
+
+	arena->top = (size_t)(start - (uintptr_t)arena->base);
+	if (arena->limit > arena->top)
+		arena->limit = arena->top;
+
+#if TILTYARD_STATS
+	arena->top_alloc_count++;
+	if (arena->capacity - arena->top > arena->top_high_water)
+		arena->top_high_water = arena->capacity - arena->top;
+#endif
+
+	return (void *)start;
+}
+
+/* Allocate 'size' bytes from the top end of the arena with the default
+ * alignment, and zero-initialize the memory.
+ *
+ * Same behavior as 'tiltyard_alloc_top' except:
+ * - The returned memory is set to all zero bytes.
+ *
+ * Returns:
+ * - A pointer into the arena if there is enough space between both ends.
+ * - NULL if there is not enough space or arena == NULL.
+ *
+ * Notes:
+ * - Only the bytes that may be dirty are zeroed, see 'tiltyard_calloc'.
+ */
+void *tiltyard_calloc_top(Arena *arena, size_t size)
+{
+	void *ptr = tiltyard_alloc_top(arena, size);
+
+	if (!ptr)
+		return NULL;
+
+	tiltyard_zero_span(arena, ptr, arena->top, size, tiltyard_dirty_mark(arena));
+	return ptr;
+}
+
+/* Frees arena and its based (which are allocated in the heap)
+ *
+ * the arena's base and the arena itself will be freed using free
+ * if 'arena' is not NULL. On growable arenas every block, including
+ * the cached ones, is freed (or pushed back to the arena's block pool), and on virtual arenas the reserved
+ * address space is unmapped.
+ *
+ * Arenas created over a caller's buffer free nothing, sub-arenas give
+ * their memory back to their parent when it was the parent's last allocation,
+ * and file arenas record their state in their file and unmap it.
+ * The mappings of the large allocations are always unmapped.
+ *
+ * Returns:
+ * - Nothing
+ *
+ * Notes:
+ * - The pointer to arena will still point to where it pointed, even
+ *   though the memory was already freed, in case you want to null the pointer
+ *   please consider using 'tiltyard_null', 'tiltyard_destroy_and_null',
+ *   or 'tiltyard_wipe_destroy_and_null'.
+ * - Until the OS process that the memory was freed, it will still contain
+ *   what it already had before freeing, in case you want to zero what you
+ *   wrote on that memory please consider using 'tiltyard_wipe'
+ *   or 'tiltyard_wipe_destroy_and_null'
+ */
+void tiltyard_destroy(Arena *arena) 
+{
+	if (!arena)
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_DESTROY, false);
+	else {
+		tiltyard_release_all_large(arena);
+
+		if (arena->kind == TILTYARD_GROWABLE_ARENA) {
+			tiltyard_drop_blocks(arena, arena->block);
+			tiltyard_drop_blocks(arena, arena->block_cache);
+		} else if (arena->parent) {
+			if (arena->parent->offset == arena->parent_end)
+				tiltyard_reset_to(arena->parent, arena->parent_marker);
+		} else if (arena->file_header) {
+			tiltyard_file_close(arena);
+		} else if (!arena->owns_base) {
+			/* The memory belongs to the caller. */
+		} else if (arena->kind == TILTYARD_VIRTUAL_ARENA) {
+			munmap(arena->base, arena->capacity);
+		} else if (arena->mapped_size) {
+			munmap(arena->base, arena->mapped_size);
+		} else {
+			free(arena->base);
+		}
+
+		if (arena->owns_header)
+			free(arena);
+	}
+}
+
+/* Zeroes all the memory in the arena.
+ *
+ * Uses tiltyard_bulk_zero to zero the entire arena if the 'arena' is not NULL,
+ * on growable arenas the cached blocks are zeroed too.
+ *
+ * Returns:
+ * - Nothing
+ *
+ * Notes:
+ * - Take into account that this function will not free the memory allocated
+ *   for the arena nor null the arena. In case you want to do any of those actions,
+ *   please consider using 'tiltyard_wipe_destroy_and_null'.
+ */
+void tiltyard_wipe(Arena *arena)
+{
+	if (!arena)
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_WIPE, false);
+
+	tiltyard_zero_range(arena, 0, arena->capacity);
+
+	for (TiltyardBlock *block = arena->block_cache; block; block = block->prev)
+		tiltyard_bulk_zero(tiltyard_block_data(block), block->capacity, arena->clean_threads, arena->clean_drop_pages);
+}
+
+/* Nulls the pointer to the arena given by the user.
+ *
+ * Nulls 'arena' if 'arena' is not already NULL.
+ *
+ * Returns:
+ * - Nothing
+ *
+ * Notes:
+ * - Take into account that if the pointer is null
+ *   there will not be any way to recover the arena, which
+ *   means there will not be any way to free it.
+ * - If you want to free the arena, use this function after you used
+ *   'tiltyard_destroy'.
+ * - The arena will keep containing what was allocated before it was nulled,
+ *   so please make sure you use 'tiltyard_wipe' before this function
+ *   or instead use 'tiltyard_wipe_destroy_and_null'.
+ */
+void tiltyard_null(Arena **arena)
+{	
+	if (!arena)
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_NULL, false);
+
+	*arena = NULL;
+}
+
+/* Destroys and nulls the arena in that order
+ *
+ * If the given arena is not NULL,
+ * combines the behaviors of 'tiltyard_destroy' and
+ * 'tiltyard_null' in that order.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Take into account that the pointer to the arena
+ *   will be null making it impossible to access the arena again.
+ * - Take into account that this function will not prevent the memory
+ *   where the arena was allocated to keep containing what it had before
+ *   it was destroyed and null. In case you want to make sure the memory was
+ *   zeroed use 'tiltyard_wipe_destroy_and_null'.
+ */
+void tiltyard_destroy_and_null(Arena **arena)
+{
+	if (!arena || !*arena)
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_DESTROY_AND_NULL, false);
+
+	tiltyard_destroy(*arena);
+	tiltyard_null(arena);
+}
+
+/* Wipes, destroys, and nulls the arena in that order.
+ *
+ * If 'arena' is not NULL, combines the behaviors of
+ * 'tiltyard_wipe' and 'tiltyard_destroy_and_null' in
+ * that order.
+ *
+ * Returns:
+ * - Nothing
+ *
+ * Notes:
+ * - Take into account that the pointer to the arena
+ *   will be null making it impossible to access the arena again.
+ */
+void tiltyard_wipe_destroy_and_null(Arena **arena)
+{
+	if (!arena || !*arena)
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_WIPE_DESTROY_AND_NULL, false);
+
+	tiltyard_wipe(*arena);
+	tiltyard_destroy_and_null(arena);
+}
+
+/* Resets the current offset to 0
+ *
+ * Allows the user to reuse the arena from the beginning
+ * by resetting the offset to 0 if the 'arena' is not NULL.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Even though the user resets the arena, the arena will still
+ *   hold the data that was allocated into it.
+ * - In case you want to reset the arena and reset all the data within it,
+ *   you should use 'tiltyard_wipe' followed by this function.
+ * - On growable arenas every block but the first one is moved to the
+ *   block cache. Arenas with a block pool only keep the first
+ *   TILTYARD_POOLED_CACHED_BLOCKS of them and push the rest back to
+ *   the pool, see 'tiltyard_create_pooled'.
+ * - Pages above the offset may be released to the OS, see
+ *   'tiltyard_set_decommit'.
+ * - Every large allocation is unmapped, see 'tiltyard_set_large_threshold'.
+ */
+void tiltyard_reset(Arena *arena)
+{
+	if (!arena)
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_RESET, true);
+
+	tiltyard_release_all_large(arena);
+	tiltyard_mark_dirty(arena);
+
+	if (arena->kind == TILTYARD_GROWABLE_ARENA) {
+		while (arena->block->prev)
+			tiltyard_release_block(arena);
+		tiltyard_trim_block_cache(arena);
+	}
+
+	if (arena->decommit_mode != TILTYARD_DECOMMIT_NEVER)
+		tiltyard_decommit_above(arena, 0);
+
+	arena->offset = 0;
+}
+
+/* Sets the policy used to release pages to the OS on resets.
+ *
+ * With a 'mode' other than TILTYARD_DECOMMIT_NEVER, 'tiltyard_reset' and
+ * 'tiltyard_reset_to' release through madvise the committed pages above
+ * the new offset, keeping 'retained_slack' bytes committed above it.
+ * To avoid faulting the same pages on every reset, pages below the peak
+ * offset reached before the previous resets are kept too.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Only fixed and virtual arenas can release pages, growable arenas
+ *   keep their released blocks in the block cache instead.
+ * - Released pages are committed again by the allocations that need them,
+ *   and the amount of bytes released and committed again are reported
+ *   by 'tiltyard_get_decommitted' and 'tiltyard_get_refaulted'.
+ * - Released pages may lose the data they had, even if it was
+ *   below the arena's high_water.
+ * - Pages can not be released while the arena has an open snapshot,
+ *   see 'tiltyard_snapshot_begin'.
+ */
+void tiltyard_set_decommit(Arena *arena, enum tiltyard_decommit_mode mode, size_t retained_slack)
+{
+	if (!arena)
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SET_DECOMMIT, true);
+
+	if ((arena->kind != TILTYARD_FIXED_ARENA && arena->kind != TILTYARD_VIRTUAL_ARENA) || arena->borrowed) {
+		tiltyard_handle_error(UNSUPPORTED_ARENA_KIND, TILTYARD_SET_DECOMMIT, true);
+		return;
+	}
+
+	if (mode != TILTYARD_DECOMMIT_NEVER && arena->snapshot_open) {
+		tiltyard_handle_error(ARENA_HAS_OPEN_SNAPSHOT, TILTYARD_SET_DECOMMIT, true);
+		return;
+	}
+
+	if (arena->commit_granule == 0)
+		arena->commit_granule = tiltyard_page_size();
+
+	arena->decommit_mode = mode;
+	arena->decommit_slack = retained_slack;
+}
+
+/* Sets how 'tiltyard_wipe' and the clean functions zero big ranges.
+ *
+ * Ranges of at least TILTYARD_CLEAN_PARALLEL_MIN bytes per thread are
+ * split across up to 'threads' threads, and with 'drop_pages' the whole
+ * pages of ranges of at least TILTYARD_CLEAN_DROP_MIN bytes are given
+ * back to the OS instead of being written, see 'tiltyard_bulk_zero'.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Ranges of at least TILTYARD_CLEAN_STREAM_MIN bytes are always
+ *   written with non-temporal stores, so they do not evict the cache.
+ * - Dropped pages are faulted in again by the first write to them,
+ *   so 'drop_pages' is worth it when the zeroed memory is not
+ *   reused right away.
+ * - Pages can not be dropped while the arena has an open snapshot,
+ *   see 'tiltyard_snapshot_begin'.
+ */
+void tiltyard_set_clean(Arena *arena, size_t threads, bool drop_pages)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SET_CLEAN, true);
+		return;
+	}
+
+	if (drop_pages && arena->borrowed) {
+		tiltyard_handle_error(UNSUPPORTED_ARENA_KIND, TILTYARD_SET_CLEAN, true);
+		return;
+	}
+
+	if (drop_pages && arena->snapshot_open) {
+		tiltyard_handle_error(ARENA_HAS_OPEN_SNAPSHOT, TILTYARD_SET_CLEAN, true);
+		return;
+	}
+
+	arena->clean_threads = threads == 0 ? 1 : threads;
+	arena->clean_drop_pages = drop_pages;
+}
+
+/* Sets the size from which allocations get their own mapping.
+ *
+ * Allocations of at least 'threshold' bytes made through 'tiltyard_alloc',
+ * 'tiltyard_alloc_aligned', their calloc and realloc variants, are not taken
+ * from the arena's memory but from a mapping of their own, so a few big
+ * buffers neither need an oversized arena nor leave it full of holes.
+ * Each of them takes a single byte of the arena, and its mapping is
+ * unmapped when the arena is reset below that byte or destroyed.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - A 'threshold' of 0 disables the large allocations, which is the
+ *   default, thresholds below TILTYARD_LARGE_THRESHOLD_MIN are raised to it.
+ * - 'tiltyard_alloc_inline' and the macros built on it only give
+ *   an allocation its own mapping when it does not fit in the arena.
+ * - The mappings are zeroed by the OS, so their calloc does not write them.
+ * - Allocations that grow or spill past the arena through its overflow
+ *   policy are kept in the same list, see 'tiltyard_set_overflow'.
+ */
+void tiltyard_set_large_threshold(Arena *arena, size_t threshold)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SET_LARGE_THRESHOLD, true);
+		return;
+	}
+
+	if (threshold == 0)
+		arena->large_threshold = SIZE_MAX;
+	else
+		arena->large_threshold = threshold < TILTYARD_LARGE_THRESHOLD_MIN ? TILTYARD_LARGE_THRESHOLD_MIN : threshold;
+}
+
+/* Sets what the arena does when an allocation does not fit in it.
+ *
+ * - TILTYARD_OVERFLOW_ABORT: the error is reported and the program
+ *   aborts, which is the default.
+ * - TILTYARD_OVERFLOW_NULL: the allocation returns NULL.
+ * - TILTYARD_OVERFLOW_FALLBACK: the allocation is made from the
+ *   fallback arena, see 'tiltyard_set_overflow_fallback'.
+ * - TILTYARD_OVERFLOW_HEAP: the allocation gets a block of the heap.
+ * - TILTYARD_OVERFLOW_GROW: the allocation gets a mapping of its own.
+ * - TILTYARD_OVERFLOW_CALLBACK: the allocation is made by the
+ *   callback, see 'tiltyard_set_overflow_callback'.
+ *
+ * Heap blocks and mappings are freed along with the arena's memory, when
+ * the arena is reset below them or destroyed, like large allocations,
+ * see 'tiltyard_set_large_threshold'.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Only allocations from the bottom end of the arena overflow,
+ *   allocations from its top end return NULL with every policy
+ *   but TILTYARD_OVERFLOW_ABORT.
+ * - Every allocation that overflowed is counted, see
+ *   'tiltyard_get_overflow_count'.
+ */
+void tiltyard_set_overflow(Arena *arena, enum tiltyard_overflow_policy policy)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SET_OVERFLOW, true);
+		return;
+	}
+
+	if ((policy == TILTYARD_OVERFLOW_FALLBACK && !arena->overflow_fallback) ||
+	    (policy == TILTYARD_OVERFLOW_CALLBACK && !arena->overflow_callback)) {
+		tiltyard_handle_error(MISSING_OVERFLOW_HANDLER, TILTYARD_SET_OVERFLOW, true);
+		return;
+	}
+
+	arena->overflow_policy = policy;
+}
+
+/* Makes the allocations that do not fit in the arena
+ * be made from 'fallback' instead.
+ *
+ * Sets the arena's overflow policy to TILTYARD_OVERFLOW_FALLBACK.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - The memory belongs to 'fallback', resetting the arena does
+ *   not free it.
+ * - When 'fallback' is full its own overflow policy applies,
+ *   fallback arenas must not form a cycle.
+ */
+void tiltyard_set_overflow_fallback(Arena *arena, Arena *fallback)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SET_OVERFLOW_FALLBACK, true);
+		return;
+	}
+
+	if (!fallback || fallback == arena) {
+		tiltyard_handle_error(MISSING_OVERFLOW_HANDLER, TILTYARD_SET_OVERFLOW_FALLBACK, true);
+		return;
+	}
+
+	arena->overflow_fallback = fallback;
+	arena->overflow_policy = TILTYARD_OVERFLOW_FALLBACK;
+}
+
+/* Makes the allocations that do not fit in the arena be made by 'callback',
+ * which is called with the arena, the size and alignment of the allocation,
+ * and 'user'.
+ *
+ * Sets the arena's overflow policy to TILTYARD_OVERFLOW_CALLBACK.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - The memory returned by 'callback' belongs to it, resetting
+ *   the arena does not free it.
+ * - 'callback' returns NULL when it cannot supply the memory either,
+ *   which is what the allocation returns then.
+ */
+void tiltyard_set_overflow_callback(Arena *arena, TiltyardOverflowCallback callback, void *user)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SET_OVERFLOW_CALLBACK, true);
+		return;
+	}
+
+	if (!callback) {
+		tiltyard_handle_error(MISSING_OVERFLOW_HANDLER, TILTYARD_SET_OVERFLOW_CALLBACK, true);
+		return;
+	}
+
+	arena->overflow_callback = callback;
+	arena->overflow_user = user;
+	arena->overflow_policy = TILTYARD_OVERFLOW_CALLBACK;
+}
+
+/* Gets current offset as a marker.
+ *
+ * Returns:
+ * - 0 if 'arena' is NULL.
+ * - Current offset if 'arena' is not NULL.
+ *
+ * Notes:
+ * - The user should take into account that even if 'arena'
+ *   is not NULL, marker can still be 0.
+ */
+size_t tiltyard_get_marker(Arena *arena)
+{
+	if (!arena)
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_MARKER, true);
+
+	return arena->offset;
+}
+
+/* Changes the current offset to 'marker'
+ *
+ * Changes the current offset to 'marker' as long
+ * as 'arena' is not NULL, marker < offset, and
+ * marker is <= the arena's capacity.
+ *
+ * Returns:
+ * - Nothing
+ *
+ * Notes:
+ * - Even if the offset offset is reset to marker, 
+ *   the arena will conserve the data it had before.
+ * - On growable arenas the blocks chained after the block of 'marker'
+ *   are moved to the block cache.
+ * - Pages above the offset may be released to the OS, see
+ *   'tiltyard_set_decommit'.
+ * - The large allocations made since 'marker' was taken are unmapped,
+ *   and so are the ones spilled, see 'tiltyard_set_overflow', while the
+ *   arena was full at 'marker'.
+ */
+void tiltyard_reset_to(Arena *arena, size_t marker)
+{
+	if (!arena)
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_RESET_TO, true);
+	
+	if (marker > arena->capacity || marker > arena->offset)
+		tiltyard_handle_error(OUT_OF_BOUNDS_MARKER, TILTYARD_RESET_TO, true);
+
+	tiltyard_release_large(arena, marker);
+	tiltyard_mark_dirty(arena);
+
+	if (arena->kind == TILTYARD_GROWABLE_ARENA) {
+		while (marker < arena->block_start)
+			tiltyard_release_block(arena);
+	}
+
+	if (arena->decommit_mode != TILTYARD_DECOMMIT_NEVER)
+		tiltyard_decommit_above(arena, marker);
+
+	arena->offset = marker;
+}
+
+/* Gets the current top of the arena as a marker of its top end.
+ *
+ * Returns:
+ * - 0 if 'arena' is NULL.
+ * - Current top if 'arena' is not NULL.
+ *
+ * Notes:
+ * - The top is the arena's capacity when nothing was
+ *   allocated from the top end.
+ */
+size_t tiltyard_get_top_marker(Arena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_TOP_MARKER, true);
+		return 0;
+	}
+
+	return arena->top;
+}
+
+/* Moves the top of the arena up to 'marker', freeing every allocation
+ * made from the top end since 'marker' was taken.
+ *
+ * Returns:
+ * - Nothing.
+ */
+static void tiltyard_move_top(Arena *arena, size_t marker)
+{
+	if (arena->top < arena->top_dirty)
+		arena->top_dirty = arena->top;
+
+	/* The bottom end was only bounded by the top, not by decommitted pages. */
+	if (arena->limit == arena->top)
+		arena->limit = marker;
+
+	arena->top = marker;
+}
+
+/* Resets the top end of the arena, freeing every allocation made from it.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - The allocations made from the bottom end are kept, see 'tiltyard_reset'.
+ */
+void tiltyard_reset_top(Arena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_RESET_TOP, true);
+		return;
+	}
+
+	tiltyard_move_top(arena, arena->capacity);
+}
+
+/* Changes the current top of the arena to 'marker'
+ *
+ * Changes the top to 'marker' as long as 'arena' is not NULL,
+ * marker >= top, and marker <= the arena's capacity.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - The allocations made from the bottom end are kept, see 'tiltyard_reset_to'.
+ */
+void tiltyard_reset_top_to(Arena *arena, size_t marker)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_RESET_TOP_TO, true);
+		return;
+	}
+
+	if (marker < arena->top || marker > arena->capacity) {
+		tiltyard_handle_error(OUT_OF_BOUNDS_MARKER, TILTYARD_RESET_TOP_TO, true);
+		return;
+	}
+
+	tiltyard_move_top(arena, marker);
+}
+
+/* Zeroes all bytes from the beginning of the arena
+ * to the marker.
+ *
+ * Zeroes all bytes from the beginning of the arena
+ * to the marker using tiltyard_bulk_zero if arena is not NULL, marker is not 0,
+ * and marker is not > arena's capacity.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - The data zeroed will not be recoverable through tiltyard by
+ *   any means, which means the user should think twice before using
+ *   this function.
+ */
+void tiltyard_clean_until(Arena *arena, size_t marker)
+{
+	if (!arena)
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_CLEAN_UNTIL, true);
+
+	if (marker == 0)
+		return;
+
+	if (marker > arena->capacity)
+		tiltyard_handle_error(OUT_OF_BOUNDS_MARKER, TILTYARD_CLEAN_UNTIL, true);
+	
+	tiltyard_zero_range(arena, 0, marker);
+}
+
+/* Zeroes all bytes from the maker to the end of the arena
+ *
+ * Zeroes all bytes from the maker
+ * to the end of the arena  using tiltyard_bulk_zero
+ * if arena is not NULL, and the marker is <= arena's capacity.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - The data zeroed will not be recoverable through tiltyard by
+ *   any means, which means the user should think twice before using
+ *   this function.
+ */
+void tiltyard_clean_from(Arena *arena, size_t marker)
+{
+	if (!arena)
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_CLEAN_FROM, true);
+
+	if (marker >= arena->capacity)
+		tiltyard_handle_error(OUT_OF_BOUNDS_MARKER, TILTYARD_CLEAN_FROM, true);
+	
+	tiltyard_zero_range(arena, marker, arena->capacity);
+}
+
+/* Zeroes all bytes from 'maker_beg' to 'marker_end'
+ *
+ * Zeroes all bytes from 'maker_beg'
+ * to 'marker_end'  using tiltyard_bulk_zero
+ * if arena is not NULL, 'maker_beg' < 'maker_end',
+ * 'marker_beg' < arena's capacity, and 'marker_end' <= arena's capacity.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - The data zeroed will not be recoverable through tiltyard by
+ *   any means, which means the user should think twice before using
+ *   this function.
+ */
+void tiltyard_clean_from_until(Arena *arena, size_t marker_beg, size_t marker_end)
+{
+	if (!arena)
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_CLEAN_FROM_UNTIL, true);
+
+	if (marker_beg >= marker_end || marker_beg >= arena->capacity || marker_end > arena->capacity)
+		tiltyard_handle_error(OUT_OF_BOUNDS_MARKER, TILTYARD_CLEAN_FROM_UNTIL, true);
+
+	tiltyard_zero_range(arena, marker_beg, marker_end);
+}
+
+/* Returns the capacity of the arena
+ *
+ * Returns arena's capacity if arena is not NULL.
+ *
+ * On growable arenas the capacity is the sum of the
+ * capacities of all the blocks chained to the arena.
+ *
+ * Returns:
+ * - 0 if 'arena' is NULL.
+ * - arena's capacity if 'arena' is not NULL.
+ *
+ * Notes:
+ *  - This function is meant to be used as a way to debug
+ *  the yards already created and it will not affect nor change
+ *  any aspect of the arena.
+ */
+size_t tiltyard_get_capacity(Arena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_CAPACITY, true);
+		return 0;
+	}
+
+	return arena->capacity;
+}
+
+/* Returns the amount of bytes used already
+ *
+ * Returns arena's offset if arena is not NULL.
+ *
+ * Returns:
+ * - 0 if 'arena' is NULL.
+ * - arena's offset if 'arena' is not NULL.
+ *
+ * Notes:
+ *  - This function is meant to be used as a way to debug
+ *  the yards already created and it will not affect nor change
+ *  any aspect of the arena.
+ *  - Take into account that arena's used capacity may be 0, which means
+ *  that even if 'arena' is not NULL you still can get 0.
+ */
+size_t tiltyard_get_used_capacity(Arena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_USED_CAPACITY, true);
+		return 0;
+	}
+
+	return arena->offset;
+}
+
+/* Return the amount of bytes available until the end of the arena
+ *
+ * Returns arena's available capacity if 'arena' is not NULL.
+ *
+ * On growable arenas this is the space left in the current block,
+ * more blocks may still be chained until max_capacity is reached.
+ * On double-ended arenas this is the space left between both ends.
+ *
+ * Returns:
+ * - 0 if 'arena' is NULL.
+ * - arena's top - arena's offset if 'arena' is not NULL.
+ *
+ * Notes:
+ *  - This function is meant to be used as a way to debug
+ *  the yards already created and it will not affect nor change
+ *  any aspect of the arena.
+ *  - Take into account that arena's available capacity  may be 0, which means
+ *  that even if 'arena' is not NULL you still can get 0.
+ */
+size_t tiltyard_get_available_capacity(Arena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_AVAILABLE_CAPACITY, true);
+		return 0;
+	}
+
+	return arena->top - arena->offset;
+}
+
+/* Return the closest allocation to the end of the arena.
+ *
+ * Returns arena's high_water if 'arena' is not NULL.
+ *
+ * Returns:
+ * - 0 if 'arena' is NULL.
+ * - arena's high_water if 'arena' is not NULL.
+ *
+ * Notes:
+ *  - This function is meant to be used as a way to debug
+ *  the yards already created and it will not affect nor change
+ *  any aspect of the arena.
+ *  - Take into account that arena's high_water  may be 0, which means
+ *  that even if 'arena' is not NULL you still can get 0.
+ */
+size_t tiltyard_get_high_water(Arena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_HIGH_WATER, true);
+		return 0;
+	}
+
+	return arena->high_water;
+}
+
+/* Return the amount of allocations in the arena.
+ *
+ * Returns arena's alloc_count if arena is not NULL.
+ *
+ * Returns:
+ * - 0 if 'arena' is NULL.
+ * - arena's alloc_count if 'arena' is not NULL.
+ *
+ * Notes:
+ *  - This function is meant to be used as a way to debug
+ *  the yards already created and it will not affect nor change
+ *  any aspect of the arena.
+ *  - Take into account that arena's alloc_count  may be 0, which means
+ *  that even if 'arena' is not NULL you still can get 0.
+ */
+size_t tiltyard_get_alloc_count(Arena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_ALLOC_COUNT, true);
+		return 0;
+	}
+
+	return arena->alloc_count;
+}
+
+/* Return the last allocation's offset in the arena.
  *
- * Uses memset to zero the entire arena if the 'arena' is not NULL
+ * Returns arena's last_alloc_offset if arena is not NULL.
  *
  * Returns:
- * - Nothing
+ * - 0 if 'arena' is NULL.
+ * - arena's last_alloc_offset if 'arena' is not NULL.
  *
  * Notes:
- * - Take into account that this function will not free the memory allocated
- *   for the arena nor null the arena. In case you want to do any of those actions,
- *   please consider using 'tiltyard_wipe_destroy_and_null'.
+ *  - This function is meant to be used as a way to debug
+ *  the yards already created and it will not affect nor change
+ *  any aspect of the arena.
+ *  - Take into account that arena's last_alloc may be 0, which means
+ *  that even if 'arena' is not NULL you still can get 0.
  */
-void tiltyard_wipe(Arena *arena)
+size_t tiltyard_get_last_alloc_offset(Arena *arena)
 {
-	if (!arena)
-		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_WIPE, false);
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_LAST_ALLOC, true);
+		return 0;
+	}
 
-	memset(arena->base, 0, arena->capacity);
+	return arena->last_alloc_offset;
 }
 
-/* Nulls the pointer to the arena given by the user.
+/* Return the amount of blocks chained to the arena.
  *
- * Nulls 'arena' if 'arena' is not already NULL.
+ * Returns arena's block_count if arena is not NULL.
  *
  * Returns:
- * - Nothing
+ * - 0 if 'arena' is NULL.
+ * - arena's block_count if 'arena' is not NULL.
  *
  * Notes:
- * - Take into account that if the pointer is null
- *   there will not be any way to recover the arena, which
- *   means there will not be any way to free it.
- * - If you want to free the arena, use this function after you used
- *   'tiltyard_destroy'.
- * - The arena will keep containing what was allocated before it was nulled,
- *   so please make sure you use 'tiltyard_wipe' before this function
- *   or instead use 'tiltyard_wipe_destroy_and_null'.
+ *  - This function is meant to be used as a way to debug
+ *  the yards already created and it will not affect nor change
+ *  any aspect of the arena.
+ *  - Arenas that are not growable always have 1 block.
  */
-void tiltyard_null(Arena **arena)
-{	
-	if (!arena)
-		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_NULL, false);
+size_t tiltyard_get_block_count(Arena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_BLOCK_COUNT, true);
+		return 0;
+	}
 
-	*arena = NULL;
+	return arena->block_count;
 }
 
-/* Destroys and nulls the arena in that order
+/* Return the amount of blocks kept in the block cache of the arena.
  *
- * If the given arena is not NULL,
- * combines the behaviors of 'tiltyard_destroy' and
- * 'tiltyard_null' in that order.
+ * Returns arena's cached_block_count if arena is not NULL.
  *
  * Returns:
- * - Nothing.
+ * - 0 if 'arena' is NULL.
+ * - arena's cached_block_count if 'arena' is not NULL.
  *
  * Notes:
- * - Take into account that the pointer to the arena
- *   will be null making it impossible to access the arena again.
- * - Take into account that this function will not prevent the memory
- *   where the arena was allocated to keep containing what it had before
- *   it was destroyed and null. In case you want to make sure the memory was
- *   zeroed use 'tiltyard_wipe_destroy_and_null'.
+ *  - This function is meant to be used as a way to debug
+ *  the yards already created and it will not affect nor change
+ *  any aspect of the arena.
+ *  - Arenas that are not growable always have 0 cached blocks.
  */
-void tiltyard_destroy_and_null(Arena **arena)
+size_t tiltyard_get_cached_block_count(Arena *arena)
 {
-	if (!arena || !*arena)
-		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_DESTROY_AND_NULL, false);
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_CACHED_BLOCK_COUNT, true);
+		return 0;
+	}
 
-	tiltyard_destroy(*arena);
-	tiltyard_null(arena);
+	return arena->cached_block_count;
 }
 
-/* Wipes, destroys, and nulls the arena in that order.
+/* Return the amount of bytes of the arena backed by memory.
  *
- * If 'arena' is not NULL, combines the behaviors of
- * 'tiltyard_wipe' and 'tiltyard_destroy_and_null' in
- * that order.
+ * Returns arena's committed watermark if arena is not NULL.
  *
  * Returns:
- * - Nothing
+ * - 0 if 'arena' is NULL.
+ * - arena's limit if 'arena' is not NULL.
  *
  * Notes:
- * - Take into account that the pointer to the arena
- *   will be null making it impossible to access the arena again.
+ *  - This function is meant to be used as a way to debug
+ *  the yards already created and it will not affect nor change
+ *  any aspect of the arena.
+ *  - Only virtual arenas and arenas whose pages were decommitted
+ *  can have less bytes committed than their capacity.
  */
-void tiltyard_wipe_destroy_and_null(Arena **arena)
+size_t tiltyard_get_committed(Arena *arena)
 {
-	if (!arena || !*arena)
-		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_WIPE_DESTROY_AND_NULL, false);
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_COMMITTED, true);
+		return 0;
+	}
 
-	tiltyard_wipe(*arena);
-	tiltyard_destroy_and_null(arena);
+	return arena->limit;
 }
 
-/* Resets the current offset to 0
+/* Return the amount of bytes released to the OS by resets.
  *
- * Allows the user to reuse the arena from the beginning
- * by resetting the offset to 0 if the 'arena' is not NULL.
+ * Returns arena's decommitted if arena is not NULL.
  *
  * Returns:
- * - Nothing.
+ * - 0 if 'arena' is NULL.
+ * - arena's decommitted if 'arena' is not NULL.
  *
  * Notes:
- * - Even though the user resets the arena, the arena will still
- *   hold the data that was allocated into it.
- * - In case you want to reset the arena and reset all the data within it,
- *   you should use 'tiltyard_wipe' followed by this function.
+ *  - This function is meant to be used as a way to debug
+ *  the yards already created and it will not affect nor change
+ *  any aspect of the arena.
  */
-void tiltyard_reset(Arena *arena)
+size_t tiltyard_get_decommitted(Arena *arena)
 {
-	if (!arena)
-		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_RESET, true);
-	
-	arena->offset = 0;
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_DECOMMITTED, true);
+		return 0;
+	}
+
+	return arena->decommitted;
 }
 
-/* Gets current offset as a marker.
+/* Return the amount of released bytes that were committed again.
+ *
+ * Returns arena's refaulted if arena is not NULL.
  *
  * Returns:
  * - 0 if 'arena' is NULL.
- * - Current offset if 'arena' is not NULL.
+ * - arena's refaulted if 'arena' is not NULL.
  *
  * Notes:
- * - The user should take into account that even if 'arena'
- *   is not NULL, marker can still be 0.
+ *  - This function is meant to be used as a way to debug
+ *  the yards already created and it will not affect nor change
+ *  any aspect of the arena.
+ *  - A refaulted value close to the decommitted value means the
+ *  arena's decommit_slack is too small for its workload.
  */
-size_t tiltyard_get_marker(Arena *arena)
+size_t tiltyard_get_refaulted(Arena *arena)
 {
-	if (!arena)
-		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_MARKER, true);
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_REFAULTED, true);
+		return 0;
+	}
 
-	return arena->offset;
+	return arena->refaulted;
 }
 
-/* Changes the current offset to 'marker'
+/* Return the offset above which the memory of the arena is known to be zero.
  *
- * Changes the current offset to 'marker' as long
- * as 'arena' is not NULL, marker < offset, and
- * marker is <= the arena's capacity.
+ * Returns the biggest of arena's offset and dirty_high_water if arena is not NULL.
  *
  * Returns:
- * - Nothing
+ * - 0 if 'arena' is NULL.
+ * - the arena's dirty mark if 'arena' is not NULL.
  *
  * Notes:
- * - Even if the offset offset is reset to marker, 
- *   the arena will conserve the data it had before.
+ *  - This function is meant to be used as a way to debug
+ *  the yards already created and it will not affect nor change
+ *  any aspect of the arena.
+ *  - 'tiltyard_calloc' only zeroes the bytes below this mark.
+ *  - Growable arenas return their capacity, since their blocks
+ *  are never known to be zero.
  */
-void tiltyard_reset_to(Arena *arena, size_t marker)
+size_t tiltyard_get_dirty_high_water(Arena *arena)
 {
-	if (!arena)
-		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_RESET_TO, true);
-	
-	if (marker > arena->capacity || marker > arena->offset)
-		tiltyard_handle_error(OUT_OF_BOUNDS_MARKER, TILTYARD_RESET_TO, true);
-	
-	arena->offset = marker;
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_DIRTY_HIGH_WATER, true);
+		return 0;
+	}
+
+	if (arena->kind == TILTYARD_GROWABLE_ARENA)
+		return arena->capacity;
+
+	return tiltyard_dirty_mark(arena);
 }
 
-/* Zeroes all bytes from the beginning of the arena
- * to the marker.
+/* Return the amount of bytes of the arena backed by transparent huge pages.
  *
- * Zeroes all bytes from the beginning of the arena
- * to the marker using memset if arena is not NULL, marker is not 0,
- * and marker is not > arena's capacity.
+ * Reads the AnonHugePages of the mappings of the arena's base
+ * from /proc/self/smaps if arena is not NULL.
  *
  * Returns:
- * - Nothing.
+ * - 0 if 'arena' is NULL.
+ * - 0 if the arena was not created with TILTYARD_CREATE_HUGE_PAGES,
+ *   or /proc/self/smaps can not be read.
+ * - arena's bytes backed by huge pages if 'arena' is not NULL.
  *
  * Notes:
- * - The data zeroed will not be recoverable through tiltyard by
- *   any means, which means the user should think twice before using
- *   this function.
+ *  - This function is meant to be used as a way to debug
+ *  the yards already created and it will not affect nor change
+ *  any aspect of the arena.
+ *  - Pages not touched yet are not backed by any page, so the value
+ *  only reaches the capacity on prefaulted arenas.
+ *  - Reading /proc/self/smaps is slow, this function must
+ *  not be called on a hot path, 'tiltyard_get_stats' only reports
+ *  whether huge pages were obtained, see 'tiltyard_get_huge_pages_obtained'.
  */
-void tiltyard_clean_until(Arena *arena, size_t marker)
+size_t tiltyard_get_huge_pages(Arena *arena)
 {
-	if (!arena)
-		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_CLEAN_UNTIL, true);
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_HUGE_PAGES, true);
+		return 0;
+	}
 
-	if (marker == 0)
-		return;
+	if (!(arena->create_options & TILTYARD_CREATE_HUGE_PAGES))
+		return 0;
 
-	if (marker > arena->capacity)
-		tiltyard_handle_error(OUT_OF_BOUNDS_MARKER, TILTYARD_CLEAN_UNTIL, true);
-	
-	memset(arena->base, 0, marker);
+	return tiltyard_smaps_huge_pages(arena->base, arena->mapped_size);
 }
 
-/* Zeroes all bytes from the maker to the end of the arena
- *
- * Zeroes all bytes from the maker
- * to the end of the arena  using memset
- * if arena is not NULL, and the marker is <= arena's capacity.
+/* Return whether the kernel gave the arena transparent huge pages.
  *
  * Returns:
- * - Nothing.
+ * - false if 'arena' is NULL.
+ * - false if the arena was not created with TILTYARD_CREATE_HUGE_PAGES,
+ *   or huge pages are not available.
+ * - true if huge pages were obtained when the arena was created.
  *
  * Notes:
- * - The data zeroed will not be recoverable through tiltyard by
- *   any means, which means the user should think twice before using
- *   this function.
+ *  - This function is meant to be used as a way to debug
+ *  the yards already created and it will not affect nor change
+ *  any aspect of the arena.
+ *  - It is recorded when the arena is created: prefaulted arenas check
+ *  the kernel backed them with huge pages, other arenas only that
+ *  madvise(MADV_HUGEPAGE) succeeded, since their pages are not touched yet.
  */
-void tiltyard_clean_from(Arena *arena, size_t marker)
+bool tiltyard_get_huge_pages_obtained(Arena *arena)
 {
-	if (!arena)
-		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_CLEAN_FROM, true);
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_HUGE_PAGES_OBTAINED, true);
+		return false;
+	}
 
-	if (marker >= arena->capacity)
-		tiltyard_handle_error(OUT_OF_BOUNDS_MARKER, TILTYARD_CLEAN_FROM, true);
-	
-	memset((char *)arena->base + marker, 0, arena->capacity - marker);
+	return arena->huge_pages;
 }
 
-/* Zeroes all bytes from 'maker_beg' to 'marker_end'
+/* Return the amount of temporary scopes of the arena not ended yet.
  *
- * Zeroes all bytes from 'maker_beg'
- * to 'marker_end'  using memset
- * if arena is not NULL, 'maker_beg' < 'maker_end',
- * 'marker_beg' < arena's capacity, and 'marker_end' <= arena's capacity.
+ * Returns arena's open_temps if arena is not NULL.
  *
  * Returns:
- * - Nothing.
+ * - 0 if 'arena' is NULL.
+ * - arena's open_temps if 'arena' is not NULL.
  *
  * Notes:
- * - The data zeroed will not be recoverable through tiltyard by
- *   any means, which means the user should think twice before using
- *   this function.
+ *  - This function is meant to be used as a way to debug
+ *  the yards already created and it will not affect nor change
+ *  any aspect of the arena.
+ *  - A value that keeps growing means a scope opened through
+ *  'tiltyard_temp_begin' is never ended.
  */
-void tiltyard_clean_from_until(Arena *arena, size_t marker_beg, size_t marker_end)
+size_t tiltyard_get_open_temps(Arena *arena)
 {
-	if (!arena)
-		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_CLEAN_FROM_UNTIL, true);
-
-	if (marker_beg >= marker_end || marker_beg >= arena->capacity || marker_end > arena->capacity)
-		tiltyard_handle_error(OUT_OF_BOUNDS_MARKER, TILTYARD_CLEAN_FROM_UNTIL, true);
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_OPEN_TEMPS, true);
+		return 0;
+	}
 
-	memset((char *)arena->base + marker_beg, 0, marker_end - marker_beg);
+	return arena->open_temps;
 }
 
-/* Returns the capacity of the arena
+/* Return the amount of bytes allocated from the top end of the arena.
  *
- * Returns arena's capacity if arena is not NULL.
+ * Returns arena's capacity - arena's top if arena is not NULL.
  *
  * Returns:
  * - 0 if 'arena' is NULL.
- * - arena's capacity if 'arena' is not NULL.
+ * - arena's capacity - arena's top if 'arena' is not NULL.
  *
  * Notes:
  *  - This function is meant to be used as a way to debug
  *  the yards already created and it will not affect nor change
  *  any aspect of the arena.
+ *  - The bytes allocated from the bottom end are
+ *  returned by 'tiltyard_get_used_capacity'.
  */
-size_t tiltyard_get_capacity(Arena *arena)
+size_t tiltyard_get_top_used(Arena *arena)
 {
 	if (!arena) {
-		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_CAPACITY, true);
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_TOP_USED, true);
 		return 0;
 	}
 
-	return arena->capacity;
+	return arena->capacity - arena->top;
 }
 
-/* Returns the amount of bytes used already
+/* Return the most bytes ever allocated from the top end of the arena.
  *
- * Returns arena's offset if arena is not NULL.
+ * Returns arena's top_high_water if arena is not NULL.
  *
  * Returns:
  * - 0 if 'arena' is NULL.
- * - arena's offset if 'arena' is not NULL.
+ * - arena's top_high_water if 'arena' is not NULL.
  *
  * Notes:
  *  - This function is meant to be used as a way to debug
  *  the yards already created and it will not affect nor change
  *  any aspect of the arena.
- *  - Take into account that arena's used capacity may be 0, which means
- *  that even if 'arena' is not NULL you still can get 0.
+ *  - Always 0 when tiltyard is built with TILTYARD_STATS=0.
  */
-size_t tiltyard_get_used_capacity(Arena *arena)
+size_t tiltyard_get_top_high_water(Arena *arena)
 {
 	if (!arena) {
-		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_USED_CAPACITY, true);
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_TOP_HIGH_WATER, true);
 		return 0;
 	}
 
-	return arena->offset;
+	return arena->top_high_water;
 }
 
-/* Return the amount of bytes available until the end of the arena
+/* Return the amount of allocations made from the top end of the arena.
  *
- * Returns arena's available capacity if 'arena' is not NULL.
+ * Returns arena's top_alloc_count if arena is not NULL.
  *
  * Returns:
  * - 0 if 'arena' is NULL.
- * - arena's capacity - arena's offset if 'arena' is not NULL.
+ * - arena's top_alloc_count if 'arena' is not NULL.
  *
  * Notes:
  *  - This function is meant to be used as a way to debug
  *  the yards already created and it will not affect nor change
  *  any aspect of the arena.
- *  - Take into account that arena's available capacity  may be 0, which means
- *  that even if 'arena' is not NULL you still can get 0.
+ *  - Always 0 when tiltyard is built with TILTYARD_STATS=0.
  */
-size_t tiltyard_get_available_capacity(Arena *arena)
+size_t tiltyard_get_top_alloc_count(Arena *arena)
 {
 	if (!arena) {
-		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_AVAILABLE_CAPACITY, true);
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_TOP_ALLOC_COUNT, true);
 		return 0;
 	}
 
-	return arena->capacity - arena->offset;
+	return arena->top_alloc_count;
 }
 
-/* Return the closest allocation to the end of the arena.
+/* Return the amount of allocations of the arena that have their own mapping.
  *
- * Returns arena's high_water if 'arena' is not NULL.
+ * Returns arena's large_count if arena is not NULL.
  *
  * Returns:
  * - 0 if 'arena' is NULL.
- * - arena's high_water if 'arena' is not NULL.
+ * - arena's large_count if 'arena' is not NULL.
  *
  * Notes:
  *  - This function is meant to be used as a way to debug
  *  the yards already created and it will not affect nor change
  *  any aspect of the arena.
- *  - Take into account that arena's high_water  may be 0, which means
- *  that even if 'arena' is not NULL you still can get 0.
  */
-size_t tiltyard_get_high_water(Arena *arena)
+size_t tiltyard_get_large_count(Arena *arena)
 {
 	if (!arena) {
-		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_HIGH_WATER, true);
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_LARGE_COUNT, true);
 		return 0;
 	}
 
-	return arena->high_water;
+	return arena->large_count;
 }
 
-/* Return the amount of allocations in the arena.
+/* Return the amount of bytes mapped for the large allocations of the arena.
  *
- * Returns arena's alloc_count if arena is not NULL.
+ * Returns arena's large_bytes if arena is not NULL.
  *
  * Returns:
  * - 0 if 'arena' is NULL.
- * - arena's alloc_count if 'arena' is not NULL.
+ * - arena's large_bytes if 'arena' is not NULL.
  *
  * Notes:
  *  - This function is meant to be used as a way to debug
  *  the yards already created and it will not affect nor change
  *  any aspect of the arena.
- *  - Take into account that arena's alloc_count  may be 0, which means
- *  that even if 'arena' is not NULL you still can get 0.
+ *  - The bytes are counted in whole pages, headers included.
  */
-size_t tiltyard_get_alloc_count(Arena *arena)
+size_t tiltyard_get_large_bytes(Arena *arena)
 {
 	if (!arena) {
-		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_ALLOC_COUNT, true);
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_LARGE_BYTES, true);
 		return 0;
 	}
 
-	return arena->alloc_count;
+	return arena->large_bytes;
 }
 
-/* Return the last allocation's offset in the arena.
+/* Return the amount of allocations that did not fit in the arena
+ * and were handled by its overflow policy.
  *
- * Returns arena's last_alloc_offset if arena is not NULL.
+ * Returns arena's overflow_count if arena is not NULL.
  *
  * Returns:
  * - 0 if 'arena' is NULL.
- * - arena's last_alloc_offset if 'arena' is not NULL.
+ * - arena's overflow_count if 'arena' is not NULL.
  *
  * Notes:
  *  - This function is meant to be used as a way to debug
  *  the yards already created and it will not affect nor change
  *  any aspect of the arena.
- *  - Take into account that arena's last_alloc may be 0, which means
- *  that even if 'arena' is not NULL you still can get 0.
  */
-size_t tiltyard_get_last_alloc_offset(Arena *arena)
+size_t tiltyard_get_overflow_count(Arena *arena)
 {
 	if (!arena) {
-		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_LAST_ALLOC, true);
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_GET_OVERFLOW_COUNT, true);
 		return 0;
 	}
 
-	return arena->last_alloc_offset;
+	return arena->overflow_count;
 }
 
 /* Return all the stats of the arena.
@@ -613,6 +3084,20 @@ TiltyardStats tiltyard_get_stats(Arena *arena)
 		.high_water = tiltyard_get_high_water(arena),
 		.alloc_count = tiltyard_get_alloc_count(arena),
 		.last_alloc_offset = tiltyard_get_last_alloc_offset(arena),
+		.block_count = tiltyard_get_block_count(arena),
+		.cached_block_count = tiltyard_get_cached_block_count(arena),
+		.committed = tiltyard_get_committed(arena),
+		.decommitted = tiltyard_get_decommitted(arena),
+		.refaulted = tiltyard_get_refaulted(arena),
+		.dirty_high_water = tiltyard_get_dirty_high_water(arena),
+		.huge_pages = tiltyard_get_huge_pages_obtained(arena),
+		.open_temps = tiltyard_get_open_temps(arena),
+		.top_used = tiltyard_get_top_used(arena),
+		.top_high_water = tiltyard_get_top_high_water(arena),
+		.top_alloc_count = tiltyard_get_top_alloc_count(arena),
+		.large_count = tiltyard_get_large_count(arena),
+		.large_bytes = tiltyard_get_large_bytes(arena),
+		.overflow_count = tiltyard_get_overflow_count(arena),
 	};
 	return stats;
 }
@@ -0,0 +1,202 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TILTYARD_CLEAN_X86 1
+#else
+#define TILTYARD_CLEAN_X86 0
+#endif
+
+#include "../include/tiltyard_Clean.h"
+
+/* Part of a range zeroed by a worker thread. */
+typedef struct {
+	uint8_t *dst;
+	size_t size;
+} TiltyardCleanJob;
+
+#if TILTYARD_CLEAN_X86
+/* Zeroes 'size' bytes at 'dst' with 32-byte non-temporal stores.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Only called when the CPU supports AVX2.
+ */
+__attribute__((target("avx2")))
+static void tiltyard_stream_zero_avx2(uint8_t *dst, size_t size)
+{
+	size_t head = (size_t)(-(uintptr_t)dst & 31);
+	memset(dst, 0, head);
+	dst += head;
+	size -= head;
+
+	__m256i zero = _mm256_setzero_si256();
+	for (; size >= 128; dst += 128, size -= 128) {
+		_mm256_stream_si256((__m256i *)(void *)dst, zero);
+		_mm256_stream_si256((__m256i *)(void *)(dst + 32), zero);
+		_mm256_stream_si256((__m256i *)(void *)(dst + 64), zero);
+		_mm256_stream_si256((__m256i *)(void *)(dst + 96), zero);
+	}
+	_mm_sfence();
+
+	memset(dst, 0, size);
+}
+
+/* Zeroes 'size' bytes at 'dst' with 16-byte non-temporal stores.
+ *
+ * Returns:
+ * - Nothing.
+ */
+__attribute__((target("sse2")))
+static void tiltyard_stream_zero_sse2(uint8_t *dst, size_t size)
+{
+	size_t head = (size_t)(-(uintptr_t)dst & 15);
+	memset(dst, 0, head);
+	dst += head;
+	size -= head;
+
+	__m128i zero = _mm_setzero_si128();
+	for (; size >= 64; dst += 64, size -= 64) {
+		_mm_stream_si128((__m128i *)(void *)dst, zero);
+		_mm_stream_si128((__m128i *)(void *)(dst + 16), zero);
+		_mm_stream_si128((__m128i *)(void *)(dst + 32), zero);
+		_mm_stream_si128((__m128i *)(void *)(dst + 48), zero);
+	}
+	_mm_sfence();
+
+	memset(dst, 0, size);
+}
+#endif
+
+/* Zeroes 'size' bytes at 'dst' from the calling thread.
+ *
+ * Ranges smaller than TILTYARD_CLEAN_STREAM_MIN use memset, bigger ones
+ * use the widest non-temporal stores supported by the CPU, checked at
+ * runtime.
+ *
+ * Returns:
+ * - Nothing.
+ */
+static void tiltyard_zero_serial(uint8_t *dst, size_t size)
+{
+	if (size < TILTYARD_CLEAN_STREAM_MIN) {
+		memset(dst, 0, size);
+		return;
+	}
+
+#if TILTYARD_CLEAN_X86
+	if (__builtin_cpu_supports("avx2")) {
+		tiltyard_stream_zero_avx2(dst, size);
+		return;
+	}
+	if (__builtin_cpu_supports("sse2")) {
+		tiltyard_stream_zero_sse2(dst, size);
+		return;
+	}
+#endif
+
+	memset(dst, 0, size);
+}
+
+/* Zeroes the part of a range given to a worker thread. */
+static void *tiltyard_clean_worker(void *job)
+{
+	TiltyardCleanJob *clean_job = job;
+
+	tiltyard_zero_serial(clean_job->dst, clean_job->size);
+	return NULL;
+}
+
+/* Zeroes 'size' bytes at 'dst' splitting them across up to 'threads' threads.
+ *
+ * Every thread gets at least TILTYARD_CLEAN_PARALLEL_MIN bytes, and the
+ * calling thread zeroes the last part itself.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - A part whose thread could not be created is zeroed
+ *   by the calling thread.
+ */
+static void tiltyard_zero_split(uint8_t *dst, size_t size, size_t threads)
+{
+	size_t parts = size / TILTYARD_CLEAN_PARALLEL_MIN;
+	if (parts > threads) parts = threads;
+	if (parts > 64) parts = 64;
+
+	if (parts <= 1) {
+		tiltyard_zero_serial(dst, size);
+		return;
+	}
+
+	size_t part_size = ((size / parts) + 63) & ~(size_t)63;
+	pthread_t workers[64];
+	TiltyardCleanJob jobs[64];
+	bool started[64];
+
+	for (size_t i = 0; i + 1 < parts; i++) {
+		jobs[i].dst = dst + i * part_size;
+		jobs[i].size = part_size;
+		started[i] = pthread_create(&workers[i], NULL, tiltyard_clean_worker, &jobs[i]) == 0;
+		if (!started[i])
+			tiltyard_zero_serial(jobs[i].dst, jobs[i].size);
+	}
+
+	size_t done = (parts - 1) * part_size;
+	tiltyard_zero_serial(dst + done, size - done);
+
+	for (size_t i = 0; i + 1 < parts; i++) {
+		if (started[i])
+			pthread_join(workers[i], NULL);
+	}
+}
+
+/* Zeroes 'size' bytes at 'dst', choosing the cheapest way for the range.
+ *
+ * Big ranges are written with non-temporal stores so they do not evict
+ * the cache, and are split across up to 'threads' threads. With
+ * 'drop_pages', the whole pages of the range are instead given back to
+ * the OS through madvise(MADV_DONTNEED), and read as zero the next time
+ * they are touched.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - 'drop_pages' must only be used on private anonymous memory
+ *   (malloc, or mmap with MAP_PRIVATE | MAP_ANONYMOUS), other mappings
+ *   read their previous contents back instead of zeroes.
+ * - Pages are only dropped when there are at least TILTYARD_CLEAN_DROP_MIN
+ *   bytes of them, touching the dropped pages again faults them back in.
+ */
+void tiltyard_bulk_zero(void *dst, size_t size, size_t threads, bool drop_pages)
+{
+	uint8_t *beg = dst;
+
+	if (size == 0) return;
+
+	if (drop_pages) {
+		long page_size = sysconf(_SC_PAGESIZE);
+		uintptr_t page_mask = (uintptr_t)(page_size > 0 ? page_size : 4096) - 1;
+		uintptr_t page_beg = ((uintptr_t)beg + page_mask) & ~page_mask;
+		uintptr_t page_end = ((uintptr_t)beg + size) & ~page_mask;
+
+		if (page_beg < page_end && page_end - page_beg >= TILTYARD_CLEAN_DROP_MIN &&
+		    madvise((void *)page_beg, (size_t)(page_end - page_beg), MADV_DONTNEED) == 0) {
+			tiltyard_zero_serial(beg, (size_t)(page_beg - (uintptr_t)beg));
+			tiltyard_zero_serial((uint8_t *)page_end, (size_t)((uintptr_t)beg + size - page_end));
+			return;
+		}
+	}
+
+	tiltyard_zero_split(beg, size, threads);
+}
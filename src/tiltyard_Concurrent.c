@@ -0,0 +1,219 @@
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../include/tiltyard_API.h"
+#include "../include/tiltyard_Concurrent.h"
+#include "../include/tiltyard_Error.h"
+
+static atomic_size_t next_shard;
+static _Thread_local size_t thread_shard = SIZE_MAX;
+
+/* Returns the counter shard used by the calling thread.
+ *
+ * Threads get their shard the first time they allocate, in turns, so
+ * up to TILTYARD_CONCURRENT_SHARDS threads never share a counter.
+ */
+static inline TiltyardCounterShard *tiltyard_concurrent_shard(TiltyardConcurrentArena *arena)
+{
+	if (thread_shard == SIZE_MAX)
+		thread_shard = atomic_fetch_add_explicit(&next_shard, 1, memory_order_relaxed) % TILTYARD_CONCURRENT_SHARDS;
+
+	return &arena->shards[thread_shard];
+}
+
+/* Create a new concurrent arena with size 'capacity'.
+ *
+ * Create space in the heap for the arena
+ * through aligned_alloc
+ *
+ * Returns:
+ * - A pointer to a concurrent arena allocated in the heap if there is enough
+ *   memory in the heap for the capacity given.
+ *
+ * Notes:
+ * - Allocates memory in the heap 2 times, one for the arena
+ *   and the other one for the base of the arena (capacity).
+ * - The memory allocated must be freed through tiltyard_concurrent_destroy.
+ */
+TiltyardConcurrentArena *tiltyard_concurrent_create(size_t capacity)
+{
+	if (capacity == 0)
+		tiltyard_handle_error(SIZE_EQUALS_ZERO, TILTYARD_CONCURRENT_CREATE, true);
+
+	size_t rounded = (capacity + 63) & ~(size_t)63;
+	if (rounded < capacity) {
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_SIZE_OF_ARENA, TILTYARD_CONCURRENT_CREATE, true);
+		return NULL;
+	}
+
+	TiltyardConcurrentArena *arena = aligned_alloc(64, sizeof(TiltyardConcurrentArena));
+	if (!arena) {
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_ARENA, TILTYARD_CONCURRENT_CREATE, true);
+		return NULL;
+	}
+
+	arena->base = aligned_alloc(64, rounded);
+	if (!arena->base) {
+		free(arena);
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_SIZE_OF_ARENA, TILTYARD_CONCURRENT_CREATE, true);
+		return NULL;
+	}
+
+	arena->capacity = capacity;
+	arena->high_water = 0;
+	arena->epoch = 0;
+	atomic_init(&arena->offset, 0);
+	for (size_t i = 0; i < TILTYARD_CONCURRENT_SHARDS; i++)
+		atomic_init(&arena->shards[i].alloc_count, 0);
+	return arena;
+}
+
+/* Allocate 'size' bytes from the concurrent arena with the default alignment
+ *
+ * Same behavior as 'tiltyard_alloc' except:
+ * - Any amount of threads can call it at the same time.
+ *
+ * Returns:
+ * - A pointer into the arena if there is enough capacity.
+ * - NULL if there is not enough space or arena == NULL.
+ */
+void *tiltyard_concurrent_alloc(TiltyardConcurrentArena *arena, size_t size)
+{
+	return tiltyard_concurrent_alloc_aligned(arena, size, sizeof(void *));
+}
+
+/* Allocate 'size' bytes from the concurrent arena with a custom alignment.
+ *
+ * The offset is moved forward with a single atomic fetch-add. Every
+ * allocation is rounded to TILTYARD_CONCURRENT_GRANULE bytes so the offset
+ * is always aligned to it, and alignments bigger than that reserve the
+ * worst-case padding, so no thread ever has to retry.
+ *
+ * Returns:
+ * - A pointer into the arena if there is enough capacity.
+ * - NULL if there is not enough space or arena == NULL.
+ *
+ * Notes:
+ * - Any amount of threads can call it at the same time.
+ * - The allocation count is kept in per-thread shards and the high_water
+ *   is computed from the offset, so neither is written by the fast path
+ *   on a cache line shared with other threads.
+ * - The memory is uninitialized.
+ */
+void *tiltyard_concurrent_alloc_aligned(TiltyardConcurrentArena *arena, size_t size, size_t alignment)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_CONCURRENT_ALLOC_ALIGNED, true);
+		return NULL;
+	}
+
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+		tiltyard_handle_error(INVALID_ALIGNMENT, TILTYARD_CONCURRENT_ALLOC_ALIGNED, true);
+
+	size_t padding = alignment > TILTYARD_CONCURRENT_GRANULE ? alignment - TILTYARD_CONCURRENT_GRANULE : 0;
+	size_t reserve = (size + TILTYARD_CONCURRENT_GRANULE - 1) & ~(size_t)(TILTYARD_CONCURRENT_GRANULE - 1);
+
+	if (reserve < size || reserve > arena->capacity || padding > arena->capacity - reserve ||
+	    atomic_load_explicit(&arena->offset, memory_order_relaxed) > arena->capacity) {
+		tiltyard_handle_error(EXCEEDED_ARENA_CAPACITY, TILTYARD_CONCURRENT_ALLOC_ALIGNED, true);
+		return NULL;
+	}
+	reserve += padding;
+
+	size_t start = atomic_fetch_add_explicit(&arena->offset, reserve, memory_order_relaxed);
+	if (start > arena->capacity || reserve > arena->capacity - start) {
+		tiltyard_handle_error(EXCEEDED_ARENA_CAPACITY, TILTYARD_CONCURRENT_ALLOC_ALIGNED, true);
+		return NULL;
+	}
+
+	atomic_fetch_add_explicit(&tiltyard_concurrent_shard(arena)->alloc_count, 1, memory_order_relaxed);
+
+	uintptr_t cursor = (uintptr_t)(arena->base + start);
+	return arena->base + start + (size_t)(-cursor & (alignment - 1));
+}
+
+/* Resets the offset of the concurrent arena to 0
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - No thread may allocate from the arena while it is reset, so it must
+ *   be called between two phases separated by a barrier (for example
+ *   pthread_barrier_wait or pthread_join).
+ * - Every reset increments 'arena->epoch', so allocations of
+ *   different phases can be told apart.
+ */
+void tiltyard_concurrent_reset(TiltyardConcurrentArena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_CONCURRENT_RESET, true);
+		return;
+	}
+
+	size_t used = atomic_load_explicit(&arena->offset, memory_order_acquire);
+	if (used > arena->capacity) used = arena->capacity;
+	if (used > arena->high_water) arena->high_water = used;
+
+	arena->epoch++;
+	atomic_store_explicit(&arena->offset, 0, memory_order_release);
+}
+
+/* Frees the concurrent arena and its base.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - No thread may use the arena while it is destroyed.
+ */
+void tiltyard_concurrent_destroy(TiltyardConcurrentArena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_CONCURRENT_DESTROY, false);
+		return;
+	}
+
+	free(arena->base);
+	free(arena);
+}
+
+/* Return all the stats of the concurrent arena.
+ *
+ * Returns:
+ * - TiltyardStats with all values zeroed if 'arena' is null.
+ * - TiltyardStats with all arena's stats if 'arena' is not null.
+ *
+ * Notes:
+ * - Allocations made by other threads while the stats are
+ *   gathered may or may not be counted.
+ * - The last allocation is not tracked by concurrent arenas, so
+ *   last_alloc_offset is always 0.
+ */
+TiltyardStats tiltyard_concurrent_get_stats(TiltyardConcurrentArena *arena)
+{
+	TiltyardStats stats = { 0 };
+
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_CONCURRENT_GET_STATS, true);
+		return stats;
+	}
+
+	size_t used = atomic_load_explicit(&arena->offset, memory_order_relaxed);
+	if (used > arena->capacity) used = arena->capacity;
+
+	size_t alloc_count = 0;
+	for (size_t i = 0; i < TILTYARD_CONCURRENT_SHARDS; i++)
+		alloc_count += atomic_load_explicit(&arena->shards[i].alloc_count, memory_order_relaxed);
+
+	stats.capacity = arena->capacity;
+	stats.used = used;
+	stats.available = arena->capacity - used;
+	stats.high_water = used > arena->high_water ? used : arena->high_water;
+	stats.alloc_count = alloc_count;
+	stats.block_count = 1;
+	stats.committed = arena->capacity;
+	return stats;
+}
@@ -0,0 +1,278 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../include/tiltyard_API.h"
+#include "../include/tiltyard_Epoch.h"
+#include "../include/tiltyard_Error.h"
+
+/* Epoch of a slot while it is being reclaimed by 'tiltyard_epoch_advance'. */
+#define TILTYARD_EPOCH_RECLAIMING (SIZE_MAX - 1)
+
+/* Create a new set of 'count' arenas with size 'capacity' each, rotated by epochs.
+ *
+ * Returns:
+ * - A pointer to the set allocated in the heap, building the epoch 0.
+ * - NULL if there is not enough memory in the heap.
+ *
+ * Notes:
+ * - 'count' must be at least 2: the epoch being built and the one being read.
+ *   Each arena more lets readers stay one more epoch behind before they
+ *   hold 'tiltyard_epoch_advance' back.
+ * - The memory allocated must be freed through tiltyard_epoch_destroy.
+ */
+TiltyardEpochSet *tiltyard_epoch_create(size_t count, size_t capacity)
+{
+	if (count < 2) {
+		tiltyard_handle_error(EPOCH_COUNT_TOO_SMALL, TILTYARD_EPOCH_CREATE, true);
+		return NULL;
+	}
+
+	if (count > SIZE_MAX / sizeof(TiltyardEpochSlot)) {
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_ARENA, TILTYARD_EPOCH_CREATE, true);
+		return NULL;
+	}
+
+	TiltyardEpochSet *set = aligned_alloc(64, sizeof(TiltyardEpochSet));
+	TiltyardEpochSlot *slots = set ? aligned_alloc(64, count * sizeof(TiltyardEpochSlot)) : NULL;
+	if (!slots) {
+		free(set);
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_ARENA, TILTYARD_EPOCH_CREATE, true);
+		return NULL;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		slots[i].arena = tiltyard_create(capacity);
+		atomic_init(&slots[i].root, NULL);
+		atomic_init(&slots[i].epoch, i == 0 ? 0 : TILTYARD_EPOCH_NONE);
+		atomic_init(&slots[i].readers, 0);
+	}
+
+	set->slots = slots;
+	set->count = count;
+	atomic_init(&set->epoch, 0);
+	return set;
+}
+
+/* Returns the arena of the epoch being built.
+ *
+ * Returns:
+ * - A pointer to the arena.
+ *
+ * Notes:
+ * - Only the thread building the epochs, the one calling
+ *   'tiltyard_epoch_advance', may allocate from it.
+ */
+Arena *tiltyard_epoch_current(TiltyardEpochSet *set)
+{
+	if (!set) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_EPOCH_CURRENT, true);
+		return NULL;
+	}
+
+	size_t epoch = atomic_load_explicit(&set->epoch, memory_order_relaxed);
+	return set->slots[epoch % set->count].arena;
+}
+
+/* Finishes the epoch being built, so readers can pin it, and starts the next one
+ * in the arena of the oldest epoch, reset in O(1).
+ *
+ * The oldest epoch is only reclaimed once every reader pinning it has left:
+ * its slot is marked as reclaimed before its readers are counted, while readers
+ * count themselves before they check the slot, so either this sees the reader
+ * or the reader sees the mark and pins a newer epoch. No lock is taken.
+ *
+ * Returns:
+ * - true if the next epoch started.
+ * - false if readers still pin the oldest epoch, nothing changed
+ *   and it can be called again later.
+ *
+ * Notes:
+ * - Only one thread, the one building the epochs, may call it.
+ * - Everything written to the finished epoch before is visible to
+ *   the readers pinning it.
+ */
+bool tiltyard_epoch_advance(TiltyardEpochSet *set)
+{
+	if (!set) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_EPOCH_ADVANCE, true);
+		return false;
+	}
+
+	size_t next = atomic_load_explicit(&set->epoch, memory_order_relaxed) + 1;
+	TiltyardEpochSlot *slot = &set->slots[next % set->count];
+
+	size_t oldest = atomic_load_explicit(&slot->epoch, memory_order_relaxed);
+	atomic_store_explicit(&slot->epoch, TILTYARD_EPOCH_RECLAIMING, memory_order_seq_cst);
+	if (atomic_load_explicit(&slot->readers, memory_order_seq_cst) != 0) {
+		atomic_store_explicit(&slot->epoch, oldest, memory_order_relaxed);
+		return false;
+	}
+
+	tiltyard_reset(slot->arena);
+	atomic_store_explicit(&slot->root, NULL, memory_order_relaxed);
+	atomic_store_explicit(&slot->epoch, next, memory_order_relaxed);
+	atomic_store_explicit(&set->epoch, next, memory_order_release);
+	return true;
+}
+
+/* Pins the last finished epoch, so its arena is not reset while it is read.
+ *
+ * Returns:
+ * - The epoch pinned, to be given back to 'tiltyard_epoch_unpin'.
+ * - TILTYARD_EPOCH_NONE if no epoch was finished yet, nothing is pinned.
+ *
+ * Notes:
+ * - Any amount of threads can call it at the same time, as many times as they want.
+ * - Readers must unpin their epoch soon: the builder cannot start the
+ *   epoch that reuses its arena until then.
+ */
+size_t tiltyard_epoch_pin(TiltyardEpochSet *set)
+{
+	if (!set) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_EPOCH_PIN, true);
+		return TILTYARD_EPOCH_NONE;
+	}
+
+	for (;;) {
+		size_t epoch = atomic_load_explicit(&set->epoch, memory_order_acquire);
+		if (epoch == 0)
+			return TILTYARD_EPOCH_NONE;
+		epoch--;
+
+		TiltyardEpochSlot *slot = &set->slots[epoch % set->count];
+		atomic_fetch_add_explicit(&slot->readers, 1, memory_order_seq_cst);
+		if (atomic_load_explicit(&slot->epoch, memory_order_seq_cst) == epoch)
+			return epoch;
+
+		/* The builder reclaimed the slot in between, pin the newer epoch. */
+		atomic_fetch_sub_explicit(&slot->readers, 1, memory_order_release);
+	}
+}
+
+/* Unpins an epoch pinned with 'tiltyard_epoch_pin'.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Nothing allocated in the epoch may be read afterwards.
+ */
+void tiltyard_epoch_unpin(TiltyardEpochSet *set, size_t epoch)
+{
+	if (!set) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_EPOCH_UNPIN, true);
+		return;
+	}
+
+	if (epoch == TILTYARD_EPOCH_NONE)
+		return;
+
+	atomic_fetch_sub_explicit(&set->slots[epoch % set->count].readers, 1, memory_order_release);
+}
+
+/* Returns the arena holding the epoch 'epoch'.
+ *
+ * Returns:
+ * - A pointer to the arena.
+ * - NULL if 'epoch' is TILTYARD_EPOCH_NONE.
+ *
+ * Notes:
+ * - Readers may only read from it while they pin 'epoch'.
+ */
+Arena *tiltyard_epoch_get_arena(TiltyardEpochSet *set, size_t epoch)
+{
+	if (!set) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_EPOCH_GET_ARENA, true);
+		return NULL;
+	}
+
+	return epoch == TILTYARD_EPOCH_NONE ? NULL : set->slots[epoch % set->count].arena;
+}
+
+/* Records 'root' as the root object of the epoch being built, the object
+ * from which readers of the epoch find everything else allocated in it.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Only the thread building the epochs may call it.
+ */
+void tiltyard_epoch_set_root(TiltyardEpochSet *set, void *root)
+{
+	if (!set) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_EPOCH_SET_ROOT, true);
+		return;
+	}
+
+	size_t epoch = atomic_load_explicit(&set->epoch, memory_order_relaxed);
+	atomic_store_explicit(&set->slots[epoch % set->count].root, root, memory_order_relaxed);
+}
+
+/* Returns the root object of the epoch 'epoch'.
+ *
+ * Returns:
+ * - A pointer to the root object.
+ * - NULL if no root object was set for the epoch or 'epoch' is TILTYARD_EPOCH_NONE.
+ *
+ * Notes:
+ * - Readers may only read it while they pin 'epoch'.
+ */
+void *tiltyard_epoch_get_root(TiltyardEpochSet *set, size_t epoch)
+{
+	if (!set) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_EPOCH_GET_ROOT, true);
+		return NULL;
+	}
+
+	if (epoch == TILTYARD_EPOCH_NONE)
+		return NULL;
+
+	return atomic_load_explicit(&set->slots[epoch % set->count].root, memory_order_relaxed);
+}
+
+/* Return the epoch being built, the amount of times the set was advanced.
+ *
+ * Returns:
+ * - 0 if 'set' is NULL.
+ * - The epoch being built otherwise.
+ *
+ * Notes:
+ *  - This function is meant to be used as a way to debug
+ *  the yards already created and it will not affect nor change
+ *  any aspect of the arena.
+ */
+size_t tiltyard_epoch_get_epoch(TiltyardEpochSet *set)
+{
+	if (!set) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_EPOCH_GET_EPOCH, true);
+		return 0;
+	}
+
+	return atomic_load_explicit(&set->epoch, memory_order_relaxed);
+}
+
+/* Frees the set and all its arenas.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - No thread may use the set, nor pin any of its epochs, while it is destroyed.
+ */
+void tiltyard_epoch_destroy(TiltyardEpochSet *set)
+{
+	if (!set) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_EPOCH_DESTROY, false);
+		return;
+	}
+
+	for (size_t i = 0; i < set->count; i++)
+		tiltyard_destroy(set->slots[i].arena);
+
+	free(set->slots);
+	free(set);
+}
@@ -12,6 +12,20 @@ static char *error_code_strings[TILTYARD_ERROR_CODE_AMOUNT + TILTYARD_ERROR_HAND
 	"The alignment provided is not valid, alignments must be any natural power of two (1,2,4,8,...)",
 	"The alignment provided was too big for the arena's capacity",
 	"The marker provided is out of bounds (it is either greater than the current capacity or greater than the current offset)",
+	"The maximum capacity of a growable arena can not be smaller than its first block",
+	"The virtual memory for the arena could not be reserved",
+	"The pages of a virtual arena could not be committed",
+	"The operation is not supported by this kind of arena",
+	"The format given to a string could not be formatted",
+	"Every scratch arena of the thread is one of the arenas it must not alias",
+	"The file of a file arena could not be opened, locked, resized or mapped",
+	"The file is not an arena file or was written by another version of tiltyard",
+	"The snapshot could not be taken, the arena has one open already or its pages could not be protected",
+	"The shared memory of a shared arena could not be created, opened, resized or mapped",
+	"The memory released is not the oldest message of the ring arena",
+	"An epoch arena set needs at least 2 arenas, the one being built and the one being read",
+	"The overflow policy needs a fallback arena or a callback, and none (or the arena itself) was given",
+	"The arena has an open snapshot, its pages can not be released to the OS until it ends",
 
 	"There was an error with tiltyard's error handling (ironical, right?). Please make sure to take an screenshot or copy the error code and send it to the Github issues section, and I will probably fix it. Thanks for using tiltyard!"
 };
@@ -40,6 +54,112 @@ static char *func_strings[TILTYARD_FUNC_AMOUNT + TILTYARD_ERROR_HANDLING_FUNC_AM
 	"tiltyard_alloc_count",
 	"tiltyard_last_alloc",
 	"tiltyard_get_stats",
+	"tiltyard_create_growable",
+	"tiltyard_get_block_count",
+	"tiltyard_get_cached_block_count",
+	"tiltyard_create_virtual",
+	"tiltyard_get_committed",
+	"tiltyard_set_decommit",
+	"tiltyard_get_decommitted",
+	"tiltyard_get_refaulted",
+	"tiltyard_create_pooled",
+	"tiltyard_thread_arena",
+	"tiltyard_thread_arena_release",
+	"tiltyard_concurrent_create",
+	"tiltyard_concurrent_alloc",
+	"tiltyard_concurrent_alloc_aligned",
+	"tiltyard_concurrent_reset",
+	"tiltyard_concurrent_destroy",
+	"tiltyard_concurrent_get_stats",
+	"tiltyard_realloc",
+	"tiltyard_realloc_aligned",
+	"tiltyard_free_last",
+	"tiltyard_vector_init",
+	"tiltyard_vector_reserve",
+	"tiltyard_vector_push_slow",
+	"tiltyard_vector_shrink",
+	"tiltyard_string_init",
+	"tiltyard_string_append",
+	"tiltyard_string_appendf",
+	"tiltyard_string_finish",
+	"tiltyard_pool_init",
+	"tiltyard_pool_alloc_slow",
+	"tiltyard_pool_reset",
+	"tiltyard_pool_get_stats",
+	"tiltyard_pool_set_init",
+	"tiltyard_pool_set_alloc",
+	"tiltyard_pool_set_free",
+	"tiltyard_pool_set_reset",
+	"tiltyard_get_dirty_high_water",
+	"tiltyard_set_clean",
+	"tiltyard_create_with_options",
+	"tiltyard_get_huge_pages",
+	"tiltyard_init_buffer",
+	"tiltyard_create_in_buffer",
+	"tiltyard_create_sub",
+	"tiltyard_temp_begin",
+	"tiltyard_temp_end",
+	"tiltyard_scratch_begin",
+	"tiltyard_get_open_temps",
+	"tiltyard_alloc_top_aligned",
+	"tiltyard_calloc_top",
+	"tiltyard_get_top_marker",
+	"tiltyard_reset_top",
+	"tiltyard_reset_top_to",
+	"tiltyard_get_top_used",
+	"tiltyard_get_top_high_water",
+	"tiltyard_get_top_alloc_count",
+	"tiltyard_map_init",
+	"tiltyard_map_insert",
+	"tiltyard_interner_init",
+	"tiltyard_intern",
+	"tiltyard_set_large_threshold",
+	"tiltyard_get_large_count",
+	"tiltyard_get_large_bytes",
+	"tiltyard_set_overflow",
+	"tiltyard_set_overflow_fallback",
+	"tiltyard_set_overflow_callback",
+	"tiltyard_get_overflow_count",
+	"tiltyard_create_file",
+	"tiltyard_file_checkpoint",
+	"tiltyard_file_set_root",
+	"tiltyard_file_get_root",
+	"tiltyard_snapshot_begin",
+	"tiltyard_snapshot_restore",
+	"tiltyard_snapshot_end",
+	"tiltyard_snapshot_get_page_count",
+	"tiltyard_shared_create",
+	"tiltyard_shared_open",
+	"tiltyard_shared_open_fd",
+	"tiltyard_shared_alloc_aligned",
+	"tiltyard_shared_handle",
+	"tiltyard_shared_resolve",
+	"tiltyard_shared_valid",
+	"tiltyard_shared_set_root",
+	"tiltyard_shared_get_root",
+	"tiltyard_shared_reset",
+	"tiltyard_shared_destroy",
+	"tiltyard_shared_get_fd",
+	"tiltyard_shared_get_generation",
+	"tiltyard_shared_get_stats",
+	"tiltyard_ring_create",
+	"tiltyard_ring_alloc",
+	"tiltyard_ring_publish",
+	"tiltyard_ring_peek",
+	"tiltyard_ring_release",
+	"tiltyard_ring_destroy",
+	"tiltyard_ring_get_stats",
+	"tiltyard_epoch_create",
+	"tiltyard_epoch_current",
+	"tiltyard_epoch_advance",
+	"tiltyard_epoch_pin",
+	"tiltyard_epoch_unpin",
+	"tiltyard_epoch_get_arena",
+	"tiltyard_epoch_set_root",
+	"tiltyard_epoch_get_root",
+	"tiltyard_epoch_get_epoch",
+	"tiltyard_epoch_destroy",
+	"tiltyard_get_huge_pages_obtained",
 
 	"get_error_code_string",
 	"get_func_string"
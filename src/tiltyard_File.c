@@ -0,0 +1,285 @@
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/tiltyard_API.h"
+#include "../include/tiltyard_Error.h"
+#include "../include/tiltyard_File.h"
+
+/* Returns the size of a page of the system. */
+static size_t tiltyard_file_page_size(void)
+{
+	long page_size = sysconf(_SC_PAGESIZE);
+
+	return page_size > 0 ? (size_t)page_size : 4096;
+}
+
+/* Checks the header of a file of 'file_size' bytes.
+ *
+ * Returns:
+ * - true if the file holds an arena of this version that fits in it.
+ * - false otherwise.
+ */
+static bool tiltyard_file_valid(const TiltyardFileHeader *header, size_t file_size)
+{
+	if (memcmp(header->magic, TILTYARD_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+	    header->version != TILTYARD_FILE_VERSION)
+		return false;
+
+	if (header->header_size < sizeof(TiltyardFileHeader) || header->header_size % 16 != 0 ||
+	    header->header_size > file_size || header->capacity != file_size - header->header_size)
+		return false;
+
+	return header->offset <= header->top && header->top <= header->capacity &&
+	       header->high_water <= header->capacity && header->root <= header->capacity;
+}
+
+/* Create an arena whose memory is the file at 'path', so its contents
+ * survive the process and are back as soon as the file is mapped again.
+ *
+ * A new (or empty) file is created with room for 'capacity' bytes and a
+ * header recording the state of the arena. An existing file is mapped as
+ * it is, with the arena's offset, top, high_water and alloc_count as of
+ * its last checkpoint, and grows to 'capacity' bytes if it is smaller.
+ *
+ * Returns:
+ * - A pointer to the arena.
+ * - NULL if the file could not be opened, mapped or locked,
+ *   or if it does not hold an arena of this version.
+ *
+ * Notes:
+ * - Objects in the arena must point to each other through TiltyardRel,
+ *   the file may map at a different address every time.
+ * - The file is locked while the arena exists, a second arena
+ *   over the same file is refused.
+ * - 'tiltyard_destroy' records the state of the arena in the header
+ *   and unmaps the file, see 'tiltyard_file_checkpoint' to make it
+ *   survive a crash as well.
+ * - Memory that overflows the arena, see 'tiltyard_set_overflow',
+ *   is not part of the file.
+ */
+Arena *tiltyard_create_file(const char *path, size_t capacity)
+{
+	if (!path) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_CREATE_FILE, true);
+		return NULL;
+	}
+
+	int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (fd < 0) {
+		tiltyard_handle_error(FILE_MAPPING_FAILED, TILTYARD_CREATE_FILE, true);
+		return NULL;
+	}
+
+	struct stat st;
+	if (flock(fd, LOCK_EX | LOCK_NB) != 0 || fstat(fd, &st) != 0) {
+		close(fd);
+		tiltyard_handle_error(FILE_MAPPING_FAILED, TILTYARD_CREATE_FILE, true);
+		return NULL;
+	}
+
+	size_t file_size = (size_t)st.st_size;
+	size_t header_size = tiltyard_file_page_size();
+	TiltyardFileHeader header;
+	memset(&header, 0, sizeof(header));
+
+	if (file_size == 0) {
+		if (capacity == 0) {
+			close(fd);
+			tiltyard_handle_error(SIZE_EQUALS_ZERO, TILTYARD_CREATE_FILE, true);
+			return NULL;
+		}
+
+		memcpy(header.magic, TILTYARD_FILE_MAGIC, sizeof(header.magic));
+		header.version = TILTYARD_FILE_VERSION;
+		header.header_size = (uint32_t)header_size;
+		header.top = capacity;
+	} else if (file_size < sizeof(header) || pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+		   !tiltyard_file_valid(&header, file_size)) {
+		close(fd);
+		tiltyard_handle_error(INVALID_FILE_FORMAT, TILTYARD_CREATE_FILE, true);
+		return NULL;
+	} else {
+		header_size = header.header_size;
+		if (capacity < header.capacity) capacity = (size_t)header.capacity;
+	}
+
+	if (capacity > SIZE_MAX - header_size || (off_t)(header_size + capacity) < 0) {
+		close(fd);
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_SIZE_OF_ARENA, TILTYARD_CREATE_FILE, true);
+		return NULL;
+	}
+
+	size_t mapped_size = header_size + capacity;
+	if (mapped_size != file_size && ftruncate(fd, (off_t)mapped_size) != 0) {
+		close(fd);
+		tiltyard_handle_error(FILE_MAPPING_FAILED, TILTYARD_CREATE_FILE, true);
+		return NULL;
+	}
+
+	uint8_t *map = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	Arena *arena = map == MAP_FAILED ? NULL : malloc(sizeof(Arena));
+	if (!arena) {
+		if (map != MAP_FAILED) munmap(map, mapped_size);
+		close(fd);
+		tiltyard_handle_error(FILE_MAPPING_FAILED, TILTYARD_CREATE_FILE, true);
+		return NULL;
+	}
+
+	/* A grown arena keeps its top end at the end of the file. */
+	if (header.top == header.capacity && capacity > header.capacity)
+		header.top = capacity;
+	header.capacity = capacity;
+	memcpy(map, &header, sizeof(header));
+
+	tiltyard_init_buffer(arena, map + header_size, capacity);
+	arena->owns_header = true;
+	arena->file_header = (TiltyardFileHeader *)(void *)map;
+	arena->file_fd = fd;
+	arena->mapped_size = mapped_size;
+
+	/* A new file reads as zero, an old one may have been written anywhere. */
+	if (file_size == 0)
+		arena->dirty_high_water = 0;
+
+	arena->offset = (size_t)header.offset;
+	arena->last_alloc_offset = arena->offset;
+	arena->top = (size_t)header.top;
+	arena->limit = arena->top;
+	arena->high_water = (size_t)header.high_water;
+	arena->alloc_count = (size_t)header.alloc_count;
+	arena->file_root = header.root;
+	return arena;
+}
+
+/* Records the state of the arena in the header of its file.
+ *
+ * Returns:
+ * - Nothing.
+ */
+static void tiltyard_file_record(Arena *arena)
+{
+	TiltyardFileHeader *header = arena->file_header;
+
+	header->offset = arena->offset;
+	header->top = arena->top;
+	header->high_water = arena->high_water;
+	header->alloc_count = arena->alloc_count;
+	header->root = arena->file_root;
+}
+
+/* Writes the arena's memory and state to its file, waiting until they
+ * are on the disk, so the arena survives the process crashing.
+ *
+ * The memory is written before the header, so the header on the disk
+ * never records allocations whose memory did not make it there.
+ *
+ * Returns:
+ * - true if the memory and the header were written.
+ * - false if 'arena' is not a file arena or the writes failed.
+ *
+ * Notes:
+ * - Between checkpoints, the kernel writes the memory to the file
+ *   on its own, and 'tiltyard_destroy' records the header.
+ */
+bool tiltyard_file_checkpoint(Arena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_FILE_CHECKPOINT, true);
+		return false;
+	}
+
+	if (!arena->file_header) {
+		tiltyard_handle_error(UNSUPPORTED_ARENA_KIND, TILTYARD_FILE_CHECKPOINT, true);
+		return false;
+	}
+
+	if (msync(arena->file_header, arena->mapped_size, MS_SYNC) != 0)
+		return false;
+
+	tiltyard_file_record(arena);
+	return msync(arena->file_header, arena->file_header->header_size, MS_SYNC) == 0;
+}
+
+/* Records 'root' as the root object of the file arena, the object
+ * from which everything else in the arena can be found again.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - 'root' must point into the arena's memory, or be NULL.
+ * - It is kept in the arena and only written to the header by the next
+ *   checkpoint (or 'tiltyard_destroy'), with the offset that covers it,
+ *   so the header never points to a root whose memory is not recorded.
+ */
+void tiltyard_file_set_root(Arena *arena, const void *root)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_FILE_SET_ROOT, true);
+		return;
+	}
+
+	if (!arena->file_header) {
+		tiltyard_handle_error(UNSUPPORTED_ARENA_KIND, TILTYARD_FILE_SET_ROOT, true);
+		return;
+	}
+
+	if (root && ((const uint8_t *)root < arena->base || (const uint8_t *)root >= arena->base + arena->capacity)) {
+		tiltyard_handle_error(OUT_OF_BOUNDS_MARKER, TILTYARD_FILE_SET_ROOT, true);
+		return;
+	}
+
+	arena->file_root = tiltyard_rel_from_ptr(arena, root);
+}
+
+/* Returns the root object of the file arena.
+ *
+ * Returns:
+ * - A pointer to the root object at the address the file is mapped now.
+ * - NULL if no root object was set or 'arena' is not a file arena.
+ *
+ * Notes:
+ * - The root set last is returned, even if no checkpoint recorded it yet.
+ */
+void *tiltyard_file_get_root(Arena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_FILE_GET_ROOT, true);
+		return NULL;
+	}
+
+	if (!arena->file_header) {
+		tiltyard_handle_error(UNSUPPORTED_ARENA_KIND, TILTYARD_FILE_GET_ROOT, true);
+		return NULL;
+	}
+
+	return tiltyard_rel_to_ptr(arena, arena->file_root);
+}
+
+/* Records the state of the file arena in its header,
+ * unmaps the file and closes it.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Called by 'tiltyard_destroy', which frees the arena afterwards.
+ * - The kernel writes what is left to the disk after the file is closed.
+ */
+void tiltyard_file_close(Arena *arena)
+{
+	tiltyard_file_record(arena);
+	munmap(arena->file_header, arena->mapped_size);
+	close(arena->file_fd);
+
+	arena->file_header = NULL;
+	arena->file_fd = -1;
+}
@@ -0,0 +1,471 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "../include/tiltyard_API.h"
+#include "../include/tiltyard_Error.h"
+#include "../include/tiltyard_Map.h"
+
+#define TILTYARD_MAP_EMPTY ((uint8_t)0x80)
+#define TILTYARD_MAP_DELETED ((uint8_t)0xFE)
+
+/* Hashes the 'size' bytes at 'data'.
+ *
+ * Mixes 8 bytes at a time and finishes with the 64-bit
+ * finalizer of MurmurHash3, so every bit of the result
+ * depends on every bit of the input.
+ *
+ * Returns:
+ * - The 64-bit hash of the bytes.
+ */
+uint64_t tiltyard_hash_bytes(const void *data, size_t size)
+{
+	const uint8_t *bytes = data;
+	uint64_t hash = 0x9E3779B97F4A7C15ull ^ size;
+	uint64_t word;
+
+	for (; size >= 8; bytes += 8, size -= 8) {
+		memcpy(&word, bytes, 8);
+		hash = (hash ^ word) * 0xBF58476D1CE4E5B9ull;
+		hash ^= hash >> 31;
+	}
+
+	word = 0;
+	memcpy(&word, bytes, size);
+	hash = (hash ^ word) * 0x94D049BB133111EBull;
+
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDull;
+	hash ^= hash >> 33;
+	hash *= 0xC4CEB9FE1A85EC53ull;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+static uint64_t tiltyard_map_default_hash(const void *key, size_t key_size)
+{
+	return tiltyard_hash_bytes(key, key_size);
+}
+
+static bool tiltyard_map_default_equal(const void *a, const void *b, size_t key_size)
+{
+	return memcmp(a, b, key_size) == 0;
+}
+
+/* Returns a mask with the bit i set for every control byte i
+ * of the group at 'group' equal to 'byte'.
+ */
+static inline uint32_t tiltyard_map_match(const uint8_t *group, uint8_t byte)
+{
+#ifdef __SSE2__
+	__m128i ctrl = _mm_load_si128((const __m128i *)(const void *)group);
+	return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)byte)));
+#else
+	uint32_t mask = 0;
+	for (uint32_t i = 0; i < TILTYARD_MAP_GROUP_WIDTH; i++)
+		mask |= (uint32_t)(group[i] == byte) << i;
+	return mask;
+#endif
+}
+
+/* Returns a mask with the bit i set for every control byte i
+ * of the group at 'group' that is empty or deleted.
+ */
+static inline uint32_t tiltyard_map_match_free(const uint8_t *group)
+{
+#ifdef __SSE2__
+	__m128i ctrl = _mm_load_si128((const __m128i *)(const void *)group);
+	return (uint32_t)_mm_movemask_epi8(ctrl);
+#else
+	uint32_t mask = 0;
+	for (uint32_t i = 0; i < TILTYARD_MAP_GROUP_WIDTH; i++)
+		mask |= (uint32_t)(group[i] >> 7) << i;
+	return mask;
+#endif
+}
+
+static inline uint8_t *tiltyard_map_slot(TiltyardMap *map, size_t index)
+{
+	return map->slots + index * map->slot_size;
+}
+
+/* Returns the index of the first empty or deleted slot
+ * of the probe sequence of 'hash'.
+ */
+static size_t tiltyard_map_find_free(TiltyardMap *map, uint64_t hash)
+{
+	size_t group_mask = map->capacity / TILTYARD_MAP_GROUP_WIDTH - 1;
+	size_t group = (size_t)(hash >> 7) & group_mask;
+
+	for (size_t step = 1;; step++) {
+		uint32_t mask = tiltyard_map_match_free(map->ctrl + group * TILTYARD_MAP_GROUP_WIDTH);
+		if (mask)
+			return group * TILTYARD_MAP_GROUP_WIDTH + (size_t)__builtin_ctz(mask);
+
+		group = (group + step) & group_mask;
+	}
+}
+
+/* Returns the index of the slot holding 'key', whose hash is 'hash'.
+ *
+ * Probes groups of control bytes in triangular order, comparing the
+ * low 7 bits of the hash with every control byte of a group at once,
+ * until the key is found or a group with an empty slot ends the probe.
+ *
+ * Returns:
+ * - The index of the slot holding 'key'.
+ * - SIZE_MAX if 'key' is not in the map.
+ */
+static size_t tiltyard_map_find_index(TiltyardMap *map, const void *key, uint64_t hash)
+{
+	if (map->capacity == 0)
+		return SIZE_MAX;
+
+	size_t group_mask = map->capacity / TILTYARD_MAP_GROUP_WIDTH - 1;
+	size_t group = (size_t)(hash >> 7) & group_mask;
+	uint8_t h2 = (uint8_t)(hash & 0x7F);
+
+	for (size_t step = 1; step <= group_mask + 1; step++) {
+		const uint8_t *ctrl = map->ctrl + group * TILTYARD_MAP_GROUP_WIDTH;
+
+		for (uint32_t mask = tiltyard_map_match(ctrl, h2); mask; mask &= mask - 1) {
+			size_t index = group * TILTYARD_MAP_GROUP_WIDTH + (size_t)__builtin_ctz(mask);
+			if (map->equal(key, tiltyard_map_slot(map, index), map->key_size))
+				return index;
+		}
+
+		if (tiltyard_map_match(ctrl, TILTYARD_MAP_EMPTY))
+			return SIZE_MAX;
+
+		group = (group + step) & group_mask;
+	}
+
+	return SIZE_MAX;
+}
+
+/* Moves the map to a new table of 'capacity' slots.
+ *
+ * The new table is allocated from the map's arena and every key is
+ * inserted again. When the old table was the last allocation of the arena,
+ * the new one is moved down over it afterwards, so growing a map that is
+ * built on its own does not leave its old tables behind in the arena.
+ *
+ * Returns:
+ * - true if the map was moved.
+ * - false if there is not enough space in the arena.
+ */
+static bool tiltyard_map_rehash(TiltyardMap *map, size_t capacity)
+{
+	size_t slots_offset = (capacity + map->alignment - 1) & ~(map->alignment - 1);
+	if (capacity > (SIZE_MAX - slots_offset) / map->slot_size) {
+		tiltyard_handle_error(EXCEEDED_ARENA_CAPACITY, TILTYARD_MAP_INSERT, true);
+		return false;
+	}
+
+	Arena *arena = map->arena;
+	size_t alignment = map->alignment > TILTYARD_MAP_GROUP_WIDTH ? map->alignment : TILTYARD_MAP_GROUP_WIDTH;
+	size_t block_size = slots_offset + capacity * map->slot_size;
+	bool was_last = map->block &&
+			map->block + map->block_size == arena->base + (arena->offset - arena->block_start);
+
+	uint8_t *block = tiltyard_alloc_aligned(arena, block_size, alignment);
+	if (!block) return false;
+
+	TiltyardMap old = *map;
+	map->block = block;
+	map->block_size = block_size;
+	map->ctrl = block;
+	map->slots = block + slots_offset;
+	map->capacity = capacity;
+	map->growth_left = capacity - capacity / 8 - map->length;
+	memset(map->ctrl, TILTYARD_MAP_EMPTY, capacity);
+
+	for (size_t i = 0; i < old.capacity; i++) {
+		if (old.ctrl[i] & 0x80) continue;
+
+		uint8_t *slot = tiltyard_map_slot(&old, i);
+		uint64_t hash = map->hash(slot, map->key_size);
+		size_t index = tiltyard_map_find_free(map, hash);
+
+		map->ctrl[index] = (uint8_t)(hash & 0x7F);
+		memcpy(tiltyard_map_slot(map, index), slot, map->slot_size);
+	}
+
+	if (was_last && block == old.block + old.block_size) {
+		memmove(old.block, block, block_size);
+		tiltyard_realloc_aligned(arena, old.block, old.block_size + block_size, block_size, alignment);
+		map->block = old.block;
+		map->ctrl = old.block;
+		map->slots = old.block + slots_offset;
+	}
+
+	return true;
+}
+
+/* Initializes an empty map in 'arena' whose keys have 'key_size' bytes and
+ * whose values have 'value_size' bytes, both aligned to 'alignment'.
+ *
+ * Reserves room for 'count' keys, if 'count' is not 0. Keys are hashed
+ * through 'hash' and compared through 'equal', or as raw bytes when
+ * they are NULL.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - The map lives in the arena, so it never needs to be freed: taking a
+ *   marker before initializing it and resetting the arena to that marker
+ *   frees the map and every key and value in it.
+ * - Reserving the final amount of keys up front avoids moving the map.
+ */
+void tiltyard_map_init(TiltyardMap *map, Arena *arena, size_t key_size, size_t value_size, size_t alignment,
+		       size_t count, TiltyardMapHash hash, TiltyardMapEqual equal)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_MAP_INIT, true);
+		return;
+	}
+
+	if (key_size == 0) {
+		tiltyard_handle_error(SIZE_EQUALS_ZERO, TILTYARD_MAP_INIT, true);
+		return;
+	}
+
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+		tiltyard_handle_error(INVALID_ALIGNMENT, TILTYARD_MAP_INIT, true);
+		return;
+	}
+
+	map->arena = arena;
+	map->block = NULL;
+	map->ctrl = NULL;
+	map->slots = NULL;
+	map->block_size = 0;
+	map->capacity = 0;
+	map->length = 0;
+	map->growth_left = 0;
+	map->key_size = key_size;
+	map->value_size = value_size;
+	map->value_offset = (key_size + alignment - 1) & ~(alignment - 1);
+	map->slot_size = (map->value_offset + value_size + alignment - 1) & ~(alignment - 1);
+	map->alignment = alignment;
+	map->hash = hash ? hash : tiltyard_map_default_hash;
+	map->equal = equal ? equal : tiltyard_map_default_equal;
+
+	if (count == 0)
+		return;
+
+	size_t capacity = TILTYARD_MAP_GROUP_WIDTH;
+	while (capacity - capacity / 8 < count && capacity <= SIZE_MAX / 2)
+		capacity *= 2;
+
+	tiltyard_map_rehash(map, capacity);
+}
+
+/* Finds the value of 'key' in the map.
+ *
+ * Returns:
+ * - A pointer to the value of 'key'.
+ * - NULL if 'key' is not in the map.
+ */
+void *tiltyard_map_find(TiltyardMap *map, const void *key)
+{
+	size_t index = tiltyard_map_find_index(map, key, map->hash(key, map->key_size));
+	if (index == SIZE_MAX)
+		return NULL;
+
+	return tiltyard_map_slot(map, index) + map->value_offset;
+}
+
+/* Finds the value of 'key' in the map, inserting 'key' if it is not there.
+ *
+ * The map grows to twice its capacity when it is 7/8 full, or is rebuilt
+ * with the same capacity when most of its slots were deleted.
+ *
+ * Returns:
+ * - A pointer to the value of 'key', which is uninitialized if
+ *   'key' was just inserted.
+ * - NULL if the map could not grow.
+ *
+ * Notes:
+ * - '*inserted' is set to whether 'key' was inserted, if 'inserted' is not NULL.
+ * - The key is copied into the map.
+ * - Pointers to the keys and values of the map become invalid
+ *   when it grows.
+ */
+void *tiltyard_map_insert(TiltyardMap *map, const void *key, bool *inserted)
+{
+	uint64_t hash = map->hash(key, map->key_size);
+	size_t index = tiltyard_map_find_index(map, key, hash);
+
+	if (inserted) *inserted = index == SIZE_MAX;
+	if (index != SIZE_MAX)
+		return tiltyard_map_slot(map, index) + map->value_offset;
+
+	if (map->growth_left == 0) {
+		size_t capacity = map->capacity == 0 ? TILTYARD_MAP_GROUP_WIDTH : map->capacity;
+		if (map->length >= capacity / 2) {
+			if (capacity > SIZE_MAX / 2) {
+				tiltyard_handle_error(EXCEEDED_ARENA_CAPACITY, TILTYARD_MAP_INSERT, true);
+				return NULL;
+			}
+			capacity *= 2;
+		}
+
+		if (!tiltyard_map_rehash(map, capacity))
+			return NULL;
+	}
+
+	index = tiltyard_map_find_free(map, hash);
+	if (map->ctrl[index] == TILTYARD_MAP_EMPTY)
+		map->growth_left--;
+
+	map->ctrl[index] = (uint8_t)(hash & 0x7F);
+	map->length++;
+
+	uint8_t *slot = tiltyard_map_slot(map, index);
+	memcpy(slot, key, map->key_size);
+	return slot + map->value_offset;
+}
+
+/* Removes 'key' from the map.
+ *
+ * Returns:
+ * - true if 'key' was removed.
+ * - false if 'key' is not in the map.
+ *
+ * Notes:
+ * - The slot of the key is marked as deleted, and it is reused by
+ *   a later insertion or dropped when the map is rebuilt.
+ */
+bool tiltyard_map_remove(TiltyardMap *map, const void *key)
+{
+	size_t index = tiltyard_map_find_index(map, key, map->hash(key, map->key_size));
+	if (index == SIZE_MAX)
+		return false;
+
+	map->ctrl[index] = TILTYARD_MAP_DELETED;
+	map->length--;
+	return true;
+}
+
+/* Gets the next key and value of the map from '*index' on.
+ *
+ * '*index' must be 0 for the first call, and it is moved past
+ * the key found on every call.
+ *
+ * Returns:
+ * - true if a key was found, with '*key' and '*value' pointing to it
+ *   and its value, if they are not NULL.
+ * - false if there are no more keys.
+ *
+ * Notes:
+ * - The keys are visited in no particular order.
+ */
+bool tiltyard_map_next(TiltyardMap *map, size_t *index, void **key, void **value)
+{
+	for (; *index < map->capacity; (*index)++) {
+		if (map->ctrl[*index] & 0x80) continue;
+
+		uint8_t *slot = tiltyard_map_slot(map, *index);
+		if (key) *key = slot;
+		if (value) *value = slot + map->value_offset;
+		(*index)++;
+		return true;
+	}
+
+	return false;
+}
+
+static uint64_t tiltyard_intern_hash(const void *key, size_t key_size)
+{
+	(void)key_size;
+	return ((const TiltyardInternKey *)key)->hash;
+}
+
+static bool tiltyard_intern_equal(const void *a, const void *b, size_t key_size)
+{
+	const TiltyardInternKey *key_a = a;
+	const TiltyardInternKey *key_b = b;
+
+	(void)key_size;
+	return key_a->hash == key_b->hash && key_a->length == key_b->length &&
+	       memcmp(key_a->data, key_b->data, key_a->length) == 0;
+}
+
+/* Initializes an empty string interner in 'arena'.
+ *
+ * Reserves room for 'count' strings, if 'count' is not 0.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Every string is stored once in the arena, so two interned
+ *   strings are equal if and only if their pointers are equal.
+ * - Like maps, the interner is freed by resetting the arena
+ *   to a marker taken before initializing it.
+ */
+void tiltyard_interner_init(TiltyardInterner *interner, Arena *arena, size_t count)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_INTERNER_INIT, true);
+		return;
+	}
+
+	tiltyard_map_init(&interner->map, arena, sizeof(TiltyardInternKey), 0, TILTYARD_ALIGNOF(TiltyardInternKey),
+			  count, tiltyard_intern_hash, tiltyard_intern_equal);
+}
+
+/* Interns the 'length' bytes at 'text'.
+ *
+ * Returns:
+ * - The copy of the string stored in the interner, terminated by '\0'.
+ * - NULL if there is not enough space in the arena.
+ *
+ * Notes:
+ * - Interning the same bytes again returns the same pointer.
+ */
+const char *tiltyard_intern(TiltyardInterner *interner, const char *text, size_t length)
+{
+	TiltyardInternKey key = { text, length, tiltyard_hash_bytes(text, length) };
+	bool inserted;
+
+	TiltyardInternKey *found = (TiltyardInternKey *)(void *)tiltyard_map_insert(&interner->map, &key, &inserted);
+	if (!found) return NULL;
+
+	/* The value is empty, so it starts where the key ends. */
+	found = (TiltyardInternKey *)(void *)((uint8_t *)found - interner->map.value_offset);
+	if (!inserted)
+		return found->data;
+
+	if (length == SIZE_MAX) {
+		tiltyard_handle_error(EXCEEDED_ARENA_CAPACITY, TILTYARD_INTERN, true);
+		return NULL;
+	}
+
+	char *copy = tiltyard_alloc_aligned(interner->map.arena, length + 1, 1);
+	if (!copy) {
+		tiltyard_map_remove(&interner->map, &key);
+		return NULL;
+	}
+
+	memcpy(copy, text, length);
+	copy[length] = '\0';
+	found->data = copy;
+	return copy;
+}
+
+/* Interns the '\0' terminated string 'text'.
+ *
+ * Same behavior as 'tiltyard_intern' with the length of 'text'.
+ */
+const char *tiltyard_intern_cstr(TiltyardInterner *interner, const char *text)
+{
+	return tiltyard_intern(interner, text, strlen(text));
+}
@@ -0,0 +1,223 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../include/tiltyard_API.h"
+#include "../include/tiltyard_Error.h"
+#include "../include/tiltyard_Pool.h"
+
+/* Initializes an empty pool of slots of 'slot_size' bytes aligned
+ * to 'alignment', carved from 'arena'.
+ *
+ * The slot size is rounded up to the alignment and to the size of
+ * a pointer, and slots are carved from chunks aligned to a cache line
+ * of at least TILTYARD_POOL_CHUNK_SIZE bytes, so slots whose size divides
+ * TILTYARD_CACHE_LINE never straddle two cache lines.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Does not allocate anything until the first slot is allocated.
+ * - The pool lives in the arena, so 'tiltyard_pool_reset' must be called
+ *   when the arena is reset below its chunks.
+ */
+void tiltyard_pool_init(TiltyardPool *pool, Arena *arena, size_t slot_size, size_t alignment)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_POOL_INIT, true);
+		return;
+	}
+
+	if (slot_size == 0)
+		tiltyard_handle_error(SIZE_EQUALS_ZERO, TILTYARD_POOL_INIT, true);
+
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+		tiltyard_handle_error(INVALID_ALIGNMENT, TILTYARD_POOL_INIT, true);
+
+	if (alignment < sizeof(TiltyardPoolSlot))
+		alignment = sizeof(TiltyardPoolSlot);
+
+	pool->arena = arena;
+	pool->slot_size = (slot_size + alignment - 1) & ~(alignment - 1);
+	pool->alignment = alignment;
+	pool->slot_count = 0;
+	pool->chunk_count = 0;
+	pool->alloc_count = 0;
+	pool->free_count = 0;
+	tiltyard_pool_reset(pool);
+}
+
+/* Slow path of 'tiltyard_pool_alloc', carves a new chunk of slots
+ * from the pool's arena and allocates the first slot of it.
+ *
+ * Returns:
+ * - A pointer to a slot of the pool's slot_size bytes.
+ * - NULL if there is not enough space in the arena.
+ *
+ * Notes:
+ * - Chunks hold a whole number of slots, so the previous chunk
+ *   has no slot left when a new one is carved.
+ */
+void *tiltyard_pool_alloc_slow(TiltyardPool *pool)
+{
+	size_t slots = TILTYARD_POOL_CHUNK_SIZE / pool->slot_size;
+	if (slots == 0) slots = 1;
+
+	size_t alignment = pool->alignment > TILTYARD_CACHE_LINE ? pool->alignment : TILTYARD_CACHE_LINE;
+	uint8_t *chunk = tiltyard_alloc_aligned(pool->arena, slots * pool->slot_size, alignment);
+	if (!chunk)
+		return NULL;
+
+	pool->chunk_cursor = chunk;
+	pool->chunk_left = slots * pool->slot_size;
+	pool->slot_count += slots;
+	pool->chunk_count++;
+	return tiltyard_pool_alloc(pool);
+}
+
+/* Forgets every slot of the pool.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Must be called after the arena of the pool is reset below the
+ *   pool's chunks, otherwise the pool would hand out memory the
+ *   arena may give to someone else.
+ * - The memory of the chunks is not given back to the arena, that is
+ *   done by resetting the arena.
+ */
+void tiltyard_pool_reset(TiltyardPool *pool)
+{
+	if (!pool) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_POOL_RESET, true);
+		return;
+	}
+
+	pool->free_list = NULL;
+	pool->chunk_cursor = NULL;
+	pool->chunk_left = 0;
+	pool->live = 0;
+	pool->slot_count = 0;
+	pool->chunk_count = 0;
+}
+
+/* Return all the stats of the pool, and of its arena.
+ *
+ * Returns:
+ * - TiltyardPoolStats with all the pool's stats.
+ *
+ * Notes:
+ *  - This function is meant to be used as a way to debug
+ *  the pools already created and it will not affect nor change
+ *  any aspect of the pool.
+ *  - 'free' counts every slot that can be allocated without
+ *  carving a new chunk.
+ */
+TiltyardPoolStats tiltyard_pool_get_stats(TiltyardPool *pool)
+{
+	TiltyardPoolStats stats = { 0 };
+
+	if (!pool) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_POOL_GET_STATS, true);
+		return stats;
+	}
+
+	stats.slot_size = pool->slot_size;
+	stats.slot_count = pool->slot_count;
+	stats.live = pool->live;
+	stats.free = pool->slot_count - pool->live;
+	stats.chunk_count = pool->chunk_count;
+	stats.alloc_count = pool->alloc_count;
+	stats.free_count = pool->free_count;
+	stats.arena = tiltyard_get_stats(pool->arena);
+	return stats;
+}
+
+/* Returns the size class of the pool set for 'size' bytes. */
+static inline size_t tiltyard_pool_class(size_t size)
+{
+	size_t class_index = 0;
+
+	while (((size_t)1 << (class_index + TILTYARD_POOL_MIN_CLASS_SHIFT)) < size)
+		class_index++;
+	return class_index;
+}
+
+/* Initializes a set of pools, one per size class, carving slots from 'arena'.
+ *
+ * Size classes are powers of two from 16 to 2048 bytes, so every class
+ * either divides a cache line or is made of whole cache lines.
+ *
+ * Returns:
+ * - Nothing.
+ */
+void tiltyard_pool_set_init(TiltyardPoolSet *set, Arena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_POOL_SET_INIT, true);
+		return;
+	}
+
+	set->arena = arena;
+	for (size_t i = 0; i < TILTYARD_POOL_CLASS_AMOUNT; i++) {
+		size_t size = (size_t)1 << (i + TILTYARD_POOL_MIN_CLASS_SHIFT);
+		tiltyard_pool_init(&set->classes[i], arena, size, size < TILTYARD_CACHE_LINE ? size : TILTYARD_CACHE_LINE);
+	}
+}
+
+/* Allocate 'size' bytes from the pool of the smallest size class that fits.
+ *
+ * Returns:
+ * - A pointer to a slot of at least 'size' bytes.
+ * - NULL if there is not enough space in the arena.
+ *
+ * Notes:
+ * - Sizes bigger than the biggest size class are allocated straight
+ *   from the arena, and are only freed by resetting the arena.
+ */
+void *tiltyard_pool_set_alloc(TiltyardPoolSet *set, size_t size)
+{
+	if (!set) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_POOL_SET_ALLOC, true);
+		return NULL;
+	}
+
+	if (size > ((size_t)1 << (TILTYARD_POOL_CLASS_AMOUNT - 1 + TILTYARD_POOL_MIN_CLASS_SHIFT)))
+		return tiltyard_alloc_aligned(set->arena, size, TILTYARD_CACHE_LINE);
+
+	return tiltyard_pool_alloc(&set->classes[tiltyard_pool_class(size)]);
+}
+
+/* Give 'size' bytes allocated from the pool set back to it.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - 'size' must be the size given to 'tiltyard_pool_set_alloc'.
+ */
+void tiltyard_pool_set_free(TiltyardPoolSet *set, void *ptr, size_t size)
+{
+	if (!set) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_POOL_SET_FREE, true);
+		return;
+	}
+
+	if (size > ((size_t)1 << (TILTYARD_POOL_CLASS_AMOUNT - 1 + TILTYARD_POOL_MIN_CLASS_SHIFT)))
+		return;
+
+	tiltyard_pool_free(&set->classes[tiltyard_pool_class(size)], ptr);
+}
+
+/* Forgets every slot of every pool of the set, see 'tiltyard_pool_reset'. */
+void tiltyard_pool_set_reset(TiltyardPoolSet *set)
+{
+	if (!set) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_POOL_SET_RESET, true);
+		return;
+	}
+
+	for (size_t i = 0; i < TILTYARD_POOL_CLASS_AMOUNT; i++)
+		tiltyard_pool_reset(&set->classes[i]);
+}
@@ -0,0 +1,294 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/tiltyard_API.h"
+#include "../include/tiltyard_Error.h"
+#include "../include/tiltyard_Ring.h"
+
+#define TILTYARD_RING_FLAGS (TILTYARD_RING_READY | TILTYARD_RING_SKIP)
+
+/* Returns the header at the position 'pos' of the ring. */
+static inline TiltyardRingHeader *tiltyard_ring_header(TiltyardRingArena *ring, size_t pos)
+{
+	return (TiltyardRingHeader *)(void *)(ring->base + (pos & ring->mask));
+}
+
+/* Moves the tail of the ring past the skipped bytes at it, if any.
+ *
+ * Returns:
+ * - The new tail of the ring.
+ */
+static size_t tiltyard_ring_skip(TiltyardRingArena *ring, size_t tail)
+{
+	TiltyardRingHeader *header = tiltyard_ring_header(ring, tail);
+	size_t word = atomic_load_explicit(&header->word, memory_order_acquire);
+
+	if ((word & TILTYARD_RING_FLAGS) != TILTYARD_RING_FLAGS)
+		return tail;
+
+	atomic_store_explicit(&header->word, 0, memory_order_relaxed);
+	tail += word & ~TILTYARD_RING_FLAGS;
+	atomic_store_explicit(&ring->tail, tail, memory_order_release);
+	return tail;
+}
+
+/* Create a new ring arena with size 'capacity'.
+ *
+ * Returns:
+ * - A pointer to a ring arena allocated in the heap if there is enough
+ *   memory in the heap for the capacity given.
+ *
+ * Notes:
+ * - 'capacity' is rounded up to a power of two.
+ * - The memory allocated must be freed through tiltyard_ring_destroy.
+ */
+TiltyardRingArena *tiltyard_ring_create(size_t capacity)
+{
+	if (capacity == 0)
+		tiltyard_handle_error(SIZE_EQUALS_ZERO, TILTYARD_RING_CREATE, true);
+
+	size_t rounded = 2 * sizeof(TiltyardRingHeader);
+	while (rounded < capacity && rounded <= SIZE_MAX / 2)
+		rounded *= 2;
+
+	if (rounded < capacity) {
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_SIZE_OF_ARENA, TILTYARD_RING_CREATE, true);
+		return NULL;
+	}
+
+	TiltyardRingArena *ring = aligned_alloc(64, sizeof(TiltyardRingArena));
+	if (!ring) {
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_ARENA, TILTYARD_RING_CREATE, true);
+		return NULL;
+	}
+
+	/* Released memory is zero, so no stale header is ever taken as ready. */
+	ring->base = aligned_alloc(64, rounded < 64 ? 64 : rounded);
+	if (!ring->base) {
+		free(ring);
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_SIZE_OF_ARENA, TILTYARD_RING_CREATE, true);
+		return NULL;
+	}
+	memset(ring->base, 0, rounded);
+
+	ring->capacity = rounded;
+	ring->mask = rounded - 1;
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->high_water, 0);
+	atomic_init(&ring->alloc_count, 0);
+	atomic_init(&ring->tail, 0);
+	return ring;
+}
+
+/* Allocate a message of 'size' bytes at the head of the ring arena.
+ *
+ * The message always is contiguous: if it does not fit before the end of
+ * the ring, the bytes up to the end are skipped and it starts at the
+ * beginning. The head is moved forward with a compare-and-swap, so any
+ * amount of producers can call it at the same time.
+ *
+ * Returns:
+ * - A pointer into the ring, aligned to TILTYARD_RING_GRANULE.
+ * - NULL if the ring is full, until the consumer releases enough messages.
+ *
+ * Notes:
+ * - A message, with its header and rounded up to TILTYARD_RING_GRANULE,
+ *   can take at most half the ring's capacity: a bigger one might never
+ *   fit even in an empty ring once the bytes skipped at its end are
+ *   counted, so it is reported as an error instead of returning NULL forever.
+ * - The message is read by the consumer once it is published, see
+ *   'tiltyard_ring_publish', or handed to it by any other mean.
+ * - The memory is uninitialized.
+ */
+void *tiltyard_ring_alloc(TiltyardRingArena *ring, size_t size)
+{
+	if (!ring) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_RING_ALLOC, true);
+		return NULL;
+	}
+
+	size_t need = (sizeof(TiltyardRingHeader) + size + TILTYARD_RING_GRANULE - 1) &
+		      ~(size_t)(TILTYARD_RING_GRANULE - 1);
+	if (size > ring->capacity / 2 || need > ring->capacity / 2) {
+		tiltyard_handle_error(EXCEEDED_ARENA_CAPACITY, TILTYARD_RING_ALLOC, true);
+		return NULL;
+	}
+
+	size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	size_t skip, used;
+	do {
+		size_t to_end = ring->capacity - (head & ring->mask);
+		skip = need > to_end ? to_end : 0;
+
+		used = head - atomic_load_explicit(&ring->tail, memory_order_acquire);
+		if (skip + need > ring->capacity - used)
+			return NULL;
+	} while (!atomic_compare_exchange_weak_explicit(&ring->head, &head, head + skip + need,
+							memory_order_relaxed, memory_order_relaxed));
+
+	if (skip) {
+		TiltyardRingHeader *padding = tiltyard_ring_header(ring, head);
+		atomic_store_explicit(&padding->word, skip | TILTYARD_RING_FLAGS, memory_order_release);
+	}
+
+	TiltyardRingHeader *header = tiltyard_ring_header(ring, head + skip);
+	header->size = size;
+	atomic_store_explicit(&header->word, need, memory_order_relaxed);
+
+#if TILTYARD_STATS
+	used += skip + need;
+	size_t high_water = atomic_load_explicit(&ring->high_water, memory_order_relaxed);
+	while (used > high_water &&
+	       !atomic_compare_exchange_weak_explicit(&ring->high_water, &high_water, used,
+						      memory_order_relaxed, memory_order_relaxed));
+	atomic_fetch_add_explicit(&ring->alloc_count, 1, memory_order_relaxed);
+#endif
+
+	return header + 1;
+}
+
+/* Publishes the message 'ptr', so the consumer can read it with 'tiltyard_ring_peek'.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Everything written to the message before is visible to the consumer.
+ * - Messages are read in the order they were allocated, a message
+ *   published early waits for the ones allocated before it.
+ */
+void tiltyard_ring_publish(TiltyardRingArena *ring, void *ptr)
+{
+	if (!ring || !ptr) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_RING_PUBLISH, true);
+		return;
+	}
+
+	TiltyardRingHeader *header = (TiltyardRingHeader *)ptr - 1;
+	size_t word = atomic_load_explicit(&header->word, memory_order_relaxed);
+	atomic_store_explicit(&header->word, word | TILTYARD_RING_READY, memory_order_release);
+}
+
+/* Returns the oldest message of the ring arena, if it was published.
+ *
+ * Returns:
+ * - A pointer to the message, whose size is written to 'size' if it is not NULL.
+ * - NULL if the ring is empty or the oldest message was not published yet.
+ *
+ * Notes:
+ * - Only the consumer may call it, the message stays in the ring
+ *   until it is released with 'tiltyard_ring_release'.
+ */
+void *tiltyard_ring_peek(TiltyardRingArena *ring, size_t *size)
+{
+	if (!ring) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_RING_PEEK, true);
+		return NULL;
+	}
+
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	if (tail == atomic_load_explicit(&ring->head, memory_order_acquire))
+		return NULL;
+
+	tail = tiltyard_ring_skip(ring, tail);
+	if (tail == atomic_load_explicit(&ring->head, memory_order_acquire))
+		return NULL;
+
+	TiltyardRingHeader *header = tiltyard_ring_header(ring, tail);
+	if (!(atomic_load_explicit(&header->word, memory_order_acquire) & TILTYARD_RING_READY))
+		return NULL;
+
+	if (size) *size = header->size;
+	return header + 1;
+}
+
+/* Releases the oldest message of the ring arena, moving the tail past it
+ * so producers can allocate its memory again.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Only the consumer may call it, and 'ptr' must be the oldest
+ *   message of the ring, the messages are released in FIFO order.
+ * - The memory of the message is zeroed, so the consumer never takes
+ *   stale bytes for the header of a message still being allocated.
+ */
+void tiltyard_ring_release(TiltyardRingArena *ring, void *ptr)
+{
+	if (!ring || !ptr) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_RING_RELEASE, true);
+		return;
+	}
+
+	size_t tail = tiltyard_ring_skip(ring, atomic_load_explicit(&ring->tail, memory_order_relaxed));
+	TiltyardRingHeader *header = tiltyard_ring_header(ring, tail);
+
+	if ((TiltyardRingHeader *)ptr - 1 != header ||
+	    tail == atomic_load_explicit(&ring->head, memory_order_acquire)) {
+		tiltyard_handle_error(RING_RELEASE_OUT_OF_ORDER, TILTYARD_RING_RELEASE, true);
+		return;
+	}
+
+	size_t need = atomic_load_explicit(&header->word, memory_order_relaxed) & ~TILTYARD_RING_FLAGS;
+	memset(header, 0, need);
+	atomic_store_explicit(&ring->tail, tail + need, memory_order_release);
+}
+
+/* Frees the ring arena and its base.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - No thread may use the ring while it is destroyed.
+ */
+void tiltyard_ring_destroy(TiltyardRingArena *ring)
+{
+	if (!ring) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_RING_DESTROY, false);
+		return;
+	}
+
+	free(ring->base);
+	free(ring);
+}
+
+/* Return all the stats of the ring arena.
+ *
+ * Returns:
+ * - TiltyardStats with all values zeroed if 'ring' is null.
+ * - TiltyardStats with all ring's stats if 'ring' is not null.
+ *
+ * Notes:
+ * - 'used' counts the messages not released yet, their headers and
+ *   the bytes skipped at the end of the ring.
+ * - The last allocation is not tracked by ring arenas, so
+ *   last_alloc_offset is always 0.
+ */
+TiltyardStats tiltyard_ring_get_stats(TiltyardRingArena *ring)
+{
+	TiltyardStats stats = { 0 };
+
+	if (!ring) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_RING_GET_STATS, true);
+		return stats;
+	}
+
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+	size_t used = atomic_load_explicit(&ring->head, memory_order_acquire) - tail;
+	if (used > ring->capacity) used = ring->capacity;
+
+	stats.capacity = ring->capacity;
+	stats.used = used;
+	stats.available = ring->capacity - used;
+	stats.high_water = atomic_load_explicit(&ring->high_water, memory_order_relaxed);
+	stats.alloc_count = atomic_load_explicit(&ring->alloc_count, memory_order_relaxed);
+	stats.block_count = 1;
+	stats.committed = ring->capacity;
+	return stats;
+}
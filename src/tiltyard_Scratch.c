@@ -0,0 +1,188 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../include/tiltyard_API.h"
+#include "../include/tiltyard_Error.h"
+#include "../include/tiltyard_Scratch.h"
+
+static atomic_size_t scratch_reserve = TILTYARD_SCRATCH_RESERVE;
+
+static pthread_once_t scratch_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t scratch_key;
+
+static _Thread_local Arena *scratch_arenas[TILTYARD_SCRATCH_COUNT];
+
+/* Opens a temporary scope of the arena.
+ *
+ * Saves the arena's current marker, everything allocated from the arena
+ * until 'tiltyard_temp_end' is called with the returned scope is freed
+ * by it.
+ *
+ * Returns:
+ * - The scope holding the arena and its marker.
+ * - A scope whose arena is NULL if 'arena' is NULL.
+ *
+ * Notes:
+ * - Scopes of the same arena can be nested, and must be
+ *   ended in the reverse order they were opened.
+ * - Use TILTYARD_TEMP_AUTO or tiltyard::TempScope to end
+ *   the scope by itself when it goes out of scope.
+ */
+TiltyardTemp tiltyard_temp_begin(Arena *arena)
+{
+	TiltyardTemp temp = { arena, 0 };
+
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_TEMP_BEGIN, true);
+		return temp;
+	}
+
+	temp.marker = tiltyard_get_marker(arena);
+	arena->open_temps++;
+	return temp;
+}
+
+/* Ends a temporary scope, resetting its arena to the saved marker.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Nothing happens if the scope's arena is NULL, which is the
+ *   case when opening the scope failed.
+ * - Ending a scope after its arena was reset below its marker
+ *   is an error, it means an outer scope was ended first.
+ */
+void tiltyard_temp_end(TiltyardTemp temp)
+{
+	if (!temp.arena) return;
+
+	if (temp.marker > temp.arena->offset) {
+		tiltyard_handle_error(OUT_OF_BOUNDS_MARKER, TILTYARD_TEMP_END, true);
+		return;
+	}
+
+	tiltyard_reset_to(temp.arena, temp.marker);
+	temp.arena->open_temps--;
+}
+
+/* Ends the temporary scope at 'temp', used by TILTYARD_TEMP_AUTO. */
+void tiltyard_temp_cleanup(TiltyardTemp *temp)
+{
+	tiltyard_temp_end(*temp);
+}
+
+/* Destroys the scratch arenas of a thread that is exiting. */
+static void tiltyard_scratch_destructor(void *arenas)
+{
+	(void)arenas;
+	tiltyard_scratch_release();
+}
+
+static void tiltyard_scratch_key_create(void)
+{
+	if (pthread_key_create(&scratch_key, tiltyard_scratch_destructor) != 0)
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_ARENA, TILTYARD_SCRATCH_BEGIN, true);
+}
+
+/* Sets the address space reserved by every scratch arena
+ * created by 'tiltyard_scratch_begin'.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Safe to call while other threads use 'tiltyard_scratch_begin',
+ *   but scratch arenas already created keep their reserve, so it is
+ *   meant to be called before any thread uses it.
+ */
+void tiltyard_scratch_configure(size_t reserve)
+{
+	atomic_store_explicit(&scratch_reserve, reserve, memory_order_relaxed);
+}
+
+/* Returns the scratch arena number 'index' of the calling thread,
+ * creating it the first time.
+ *
+ * Returns:
+ * - A pointer to the scratch arena.
+ * - NULL if the arena could not be created.
+ */
+static Arena *tiltyard_scratch_arena(size_t index)
+{
+	if (scratch_arenas[index]) return scratch_arenas[index];
+
+	pthread_once(&scratch_key_once, tiltyard_scratch_key_create);
+
+	size_t reserve = atomic_load_explicit(&scratch_reserve, memory_order_relaxed);
+	scratch_arenas[index] = tiltyard_create_virtual(reserve, TILTYARD_SCRATCH_COMMIT_GRANULE);
+	if (scratch_arenas[index] && pthread_setspecific(scratch_key, scratch_arenas) != 0)
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_ARENA, TILTYARD_SCRATCH_BEGIN, true);
+
+	return scratch_arenas[index];
+}
+
+/* Opens a temporary scope on a scratch arena of the calling thread.
+ *
+ * Every thread has TILTYARD_SCRATCH_COUNT scratch arenas, created the first
+ * time they are needed. The scope is opened on the first of them that is
+ * not one of the 'conflict_count' arenas in 'conflicts', so a function can
+ * pass the arena its results are allocated in, which may itself be a
+ * scratch arena of its caller, and never get scratch memory that is reset
+ * under the results.
+ *
+ * Returns:
+ * - The scope holding the scratch arena and its marker.
+ * - A scope whose arena is NULL if every scratch arena conflicts
+ *   or a scratch arena could not be created.
+ *
+ * Notes:
+ * - The scope must be ended through 'tiltyard_temp_end', or opened
+ *   through TILTYARD_SCRATCH_AUTO or tiltyard::TempScope.
+ * - Scratch arenas are virtual arenas, so their memory is only
+ *   committed as it is used.
+ */
+TiltyardTemp tiltyard_scratch_begin(Arena *const *conflicts, size_t conflict_count)
+{
+	TiltyardTemp temp = { NULL, 0 };
+
+	for (size_t i = 0; i < TILTYARD_SCRATCH_COUNT; i++) {
+		Arena *arena = tiltyard_scratch_arena(i);
+		if (!arena) return temp;
+
+		bool conflict = false;
+		for (size_t j = 0; j < conflict_count && !conflict; j++)
+			conflict = conflicts[j] == arena;
+
+		if (!conflict)
+			return tiltyard_temp_begin(arena);
+	}
+
+	tiltyard_handle_error(SCRATCH_ARENAS_CONFLICT, TILTYARD_SCRATCH_BEGIN, true);
+	return temp;
+}
+
+/* Destroys every scratch arena of the calling thread.
+ *
+ * New scratch arenas are created the next time the
+ * thread calls 'tiltyard_scratch_begin'.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - No scope of the thread's scratch arenas may be open.
+ * - Called by itself when a thread that used scratch arenas exits.
+ */
+void tiltyard_scratch_release(void)
+{
+	for (size_t i = 0; i < TILTYARD_SCRATCH_COUNT; i++) {
+		if (!scratch_arenas[i]) continue;
+
+		tiltyard_destroy(scratch_arenas[i]);
+		scratch_arenas[i] = NULL;
+	}
+}
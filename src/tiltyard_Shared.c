@@ -0,0 +1,500 @@
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/tiltyard_API.h"
+#include "../include/tiltyard_Error.h"
+#include "../include/tiltyard_Shared.h"
+
+#define TILTYARD_SHARED_OFFSET_MASK (((uint64_t)1 << TILTYARD_SHARED_OFFSET_BITS) - 1)
+#define TILTYARD_SHARED_GENERATION_MASK (UINT64_MAX >> TILTYARD_SHARED_OFFSET_BITS)
+
+/* Returns the size of a page of the system. */
+static size_t tiltyard_shared_page_size(void)
+{
+	long page_size = sysconf(_SC_PAGESIZE);
+
+	return page_size > 0 ? (size_t)page_size : 4096;
+}
+
+/* Maps the shared memory of 'fd', of 'mapped_size' bytes, into a new shared arena.
+ *
+ * Returns:
+ * - A pointer to the arena.
+ * - NULL if the memory could not be mapped.
+ *
+ * Notes:
+ * - 'fd' is closed if the arena could not be created.
+ */
+static TiltyardSharedArena *tiltyard_shared_map(int fd, size_t mapped_size)
+{
+	uint8_t *map = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	TiltyardSharedArena *arena = map == MAP_FAILED ? NULL : malloc(sizeof(TiltyardSharedArena));
+	if (!arena) {
+		if (map != MAP_FAILED) munmap(map, mapped_size);
+		close(fd);
+		return NULL;
+	}
+
+	arena->header = (TiltyardSharedHeader *)(void *)map;
+	arena->mapped_size = mapped_size;
+	arena->fd = fd;
+	arena->name = NULL;
+	return arena;
+}
+
+/* Create a new shared arena with size 'capacity', whose memory other
+ * processes can map with 'tiltyard_shared_open' or 'tiltyard_shared_open_fd'.
+ *
+ * The memory is a POSIX shared memory object called 'name' (like "/results"),
+ * or an anonymous memfd if 'name' is NULL, passed to the other processes
+ * through fork or a unix socket, see 'tiltyard_shared_get_fd'.
+ *
+ * Returns:
+ * - A pointer to the shared arena.
+ * - NULL if the shared memory could not be created or mapped,
+ *   or if there is already a shared memory object called 'name'.
+ *
+ * Notes:
+ * - 'tiltyard_shared_destroy' removes the name of the shared memory object,
+ *   the processes that mapped it keep their mapping.
+ * - The memory reads as zero until it is allocated.
+ */
+TiltyardSharedArena *tiltyard_shared_create(const char *name, size_t capacity)
+{
+	if (capacity == 0) {
+		tiltyard_handle_error(SIZE_EQUALS_ZERO, TILTYARD_SHARED_CREATE, true);
+		return NULL;
+	}
+
+	size_t header_size = tiltyard_shared_page_size();
+	if (capacity > TILTYARD_SHARED_MAX_CAPACITY) {
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_SIZE_OF_ARENA, TILTYARD_SHARED_CREATE, true);
+		return NULL;
+	}
+
+	char *name_copy = name ? strdup(name) : NULL;
+	int fd = name ? shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600) : memfd_create("tiltyard", MFD_CLOEXEC);
+	if (fd < 0 || (name && !name_copy)) {
+		if (fd >= 0) {
+			close(fd);
+			shm_unlink(name);
+		}
+		free(name_copy);
+		tiltyard_handle_error(SHARED_MEMORY_FAILED, TILTYARD_SHARED_CREATE, true);
+		return NULL;
+	}
+
+	size_t mapped_size = header_size + capacity;
+	TiltyardSharedArena *arena = NULL;
+	if (ftruncate(fd, (off_t)mapped_size) == 0)
+		arena = tiltyard_shared_map(fd, mapped_size);
+	else
+		close(fd);
+
+	if (!arena) {
+		if (name) shm_unlink(name);
+		free(name_copy);
+		tiltyard_handle_error(SHARED_MEMORY_FAILED, TILTYARD_SHARED_CREATE, true);
+		return NULL;
+	}
+
+	TiltyardSharedHeader *header = arena->header;
+	header->version = TILTYARD_SHARED_VERSION;
+	header->header_size = (uint32_t)header_size;
+	header->capacity = capacity;
+	atomic_init(&header->offset, 0);
+	atomic_init(&header->generation, 0);
+	atomic_init(&header->root, 0);
+	atomic_init(&header->high_water, 0);
+	atomic_init(&header->alloc_count, 0);
+
+	/* The magic goes last, so the header is complete once it can be opened. */
+	atomic_thread_fence(memory_order_release);
+	memcpy(header->magic, TILTYARD_SHARED_MAGIC, sizeof(header->magic));
+
+	arena->base = (uint8_t *)header + header_size;
+	arena->capacity = capacity;
+	arena->name = name_copy;
+	return arena;
+}
+
+/* Map the shared memory of a shared arena created by another process, from its 'fd'.
+ *
+ * Returns:
+ * - A pointer to the shared arena.
+ * - NULL if 'fd' could not be mapped or does not hold a shared arena of this version.
+ *
+ * Notes:
+ * - The arena takes 'fd' over, it is closed by 'tiltyard_shared_destroy'.
+ */
+TiltyardSharedArena *tiltyard_shared_open_fd(int fd)
+{
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) != 0) {
+		if (fd >= 0) close(fd);
+		tiltyard_handle_error(SHARED_MEMORY_FAILED, TILTYARD_SHARED_OPEN_FD, true);
+		return NULL;
+	}
+
+	size_t mapped_size = (size_t)st.st_size;
+	if (mapped_size < sizeof(TiltyardSharedHeader)) {
+		close(fd);
+		tiltyard_handle_error(INVALID_FILE_FORMAT, TILTYARD_SHARED_OPEN_FD, true);
+		return NULL;
+	}
+
+	TiltyardSharedArena *arena = tiltyard_shared_map(fd, mapped_size);
+	if (!arena) {
+		tiltyard_handle_error(SHARED_MEMORY_FAILED, TILTYARD_SHARED_OPEN_FD, true);
+		return NULL;
+	}
+
+	TiltyardSharedHeader *header = arena->header;
+	bool valid = memcmp(header->magic, TILTYARD_SHARED_MAGIC, sizeof(header->magic)) == 0;
+	atomic_thread_fence(memory_order_acquire);
+
+	if (!valid || header->version != TILTYARD_SHARED_VERSION ||
+	    header->header_size < sizeof(TiltyardSharedHeader) || header->header_size > mapped_size ||
+	    header->capacity != mapped_size - header->header_size) {
+		munmap(header, mapped_size);
+		close(fd);
+		free(arena);
+		tiltyard_handle_error(INVALID_FILE_FORMAT, TILTYARD_SHARED_OPEN_FD, true);
+		return NULL;
+	}
+
+	arena->base = (uint8_t *)header + header->header_size;
+	arena->capacity = (size_t)header->capacity;
+	return arena;
+}
+
+/* Map the shared memory of the shared arena called 'name', created by another process.
+ *
+ * Returns:
+ * - A pointer to the shared arena.
+ * - NULL if there is no shared memory object called 'name', if it could not
+ *   be mapped or does not hold a shared arena of this version.
+ */
+TiltyardSharedArena *tiltyard_shared_open(const char *name)
+{
+	if (!name) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SHARED_OPEN, true);
+		return NULL;
+	}
+
+	int fd = shm_open(name, O_RDWR, 0);
+	if (fd < 0) {
+		tiltyard_handle_error(SHARED_MEMORY_FAILED, TILTYARD_SHARED_OPEN, true);
+		return NULL;
+	}
+
+	return tiltyard_shared_open_fd(fd);
+}
+
+/* Allocate 'size' bytes from the shared arena with the default alignment
+ *
+ * Same behavior as 'tiltyard_shared_alloc_aligned' with the alignment of a pointer.
+ */
+void *tiltyard_shared_alloc(TiltyardSharedArena *arena, size_t size)
+{
+	return tiltyard_shared_alloc_aligned(arena, size, sizeof(void *));
+}
+
+/* Allocate 'size' bytes from the shared arena with a custom alignment.
+ *
+ * Same behavior as 'tiltyard_concurrent_alloc_aligned' except:
+ * - The offset lives in the shared header, so any amount of threads
+ *   of any of the processes mapping the arena can call it at the same time.
+ *
+ * Returns:
+ * - A pointer into the arena, at this process' address of the memory.
+ * - NULL if there is not enough space or arena == NULL.
+ *
+ * Notes:
+ * - Other processes must be handed a TiltyardSharedHandle of the memory,
+ *   see 'tiltyard_shared_handle', not the pointer.
+ * - Alignments bigger than a page are only kept in this process.
+ */
+void *tiltyard_shared_alloc_aligned(TiltyardSharedArena *arena, size_t size, size_t alignment)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SHARED_ALLOC_ALIGNED, true);
+		return NULL;
+	}
+
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+		tiltyard_handle_error(INVALID_ALIGNMENT, TILTYARD_SHARED_ALLOC_ALIGNED, true);
+
+	size_t padding = alignment > TILTYARD_SHARED_GRANULE ? alignment - TILTYARD_SHARED_GRANULE : 0;
+	size_t reserve = (size + TILTYARD_SHARED_GRANULE - 1) & ~(size_t)(TILTYARD_SHARED_GRANULE - 1);
+
+	if (reserve < size || reserve > arena->capacity || padding > arena->capacity - reserve ||
+	    atomic_load_explicit(&arena->header->offset, memory_order_relaxed) > arena->capacity) {
+		tiltyard_handle_error(EXCEEDED_ARENA_CAPACITY, TILTYARD_SHARED_ALLOC_ALIGNED, true);
+		return NULL;
+	}
+	reserve += padding;
+
+	size_t start = (size_t)atomic_fetch_add_explicit(&arena->header->offset, reserve, memory_order_relaxed);
+	if (start > arena->capacity || reserve > arena->capacity - start) {
+		tiltyard_handle_error(EXCEEDED_ARENA_CAPACITY, TILTYARD_SHARED_ALLOC_ALIGNED, true);
+		return NULL;
+	}
+
+#if TILTYARD_STATS
+	atomic_fetch_add_explicit(&arena->header->alloc_count, 1, memory_order_relaxed);
+#endif
+
+	uintptr_t cursor = (uintptr_t)(arena->base + start);
+	return arena->base + start + (size_t)(-cursor & (alignment - 1));
+}
+
+/* Returns the handle of 'ptr', which points into the memory of the shared
+ * arena, tagged with the current generation of the arena.
+ *
+ * Returns:
+ * - The handle, which any process mapping the arena can resolve.
+ * - 0 if 'ptr' is NULL or does not point into the arena.
+ */
+TiltyardSharedHandle tiltyard_shared_handle(TiltyardSharedArena *arena, const void *ptr)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SHARED_HANDLE, true);
+		return 0;
+	}
+
+	if (!ptr || (const uint8_t *)ptr < arena->base || (const uint8_t *)ptr >= arena->base + arena->capacity)
+		return 0;
+
+	uint64_t generation = atomic_load_explicit(&arena->header->generation, memory_order_relaxed);
+	return ((generation & TILTYARD_SHARED_GENERATION_MASK) << TILTYARD_SHARED_OFFSET_BITS) |
+	       ((uint64_t)((const uint8_t *)ptr - arena->base) + 1);
+}
+
+/* Returns the pointer to the object of 'handle', at this process' address of the memory.
+ *
+ * Returns:
+ * - The pointer to the object.
+ * - NULL if 'handle' is 0, out of the arena, or of an older generation,
+ *   that is, the arena was reset since the handle was made.
+ *
+ * Notes:
+ * - The arena may still be reset while the object is read, see 'tiltyard_shared_valid'.
+ */
+void *tiltyard_shared_resolve(TiltyardSharedArena *arena, TiltyardSharedHandle handle)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SHARED_RESOLVE, true);
+		return NULL;
+	}
+
+	uint64_t position = handle & TILTYARD_SHARED_OFFSET_MASK;
+	if (position == 0 || position > arena->capacity || !tiltyard_shared_valid(arena, handle))
+		return NULL;
+
+	return arena->base + (size_t)(position - 1);
+}
+
+/* Checks the generation of 'handle' against the one of the shared arena.
+ *
+ * Readers check it again after reading the object of the handle, like with
+ * a seqlock: if it is still valid, the arena was not reset while it was read
+ * and what was read is the object as it was allocated.
+ *
+ * Returns:
+ * - true if the arena was not reset since 'handle' was made.
+ * - false otherwise.
+ */
+bool tiltyard_shared_valid(TiltyardSharedArena *arena, TiltyardSharedHandle handle)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SHARED_VALID, true);
+		return false;
+	}
+
+	atomic_thread_fence(memory_order_acquire);
+	uint64_t generation = atomic_load_explicit(&arena->header->generation, memory_order_relaxed);
+	return (generation & TILTYARD_SHARED_GENERATION_MASK) == handle >> TILTYARD_SHARED_OFFSET_BITS;
+}
+
+/* Publishes 'root' as the root object of the shared arena, the object
+ * from which consumers find everything else the producer allocated.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Everything written before it is visible to the processes that
+ *   read the root with 'tiltyard_shared_get_root'.
+ */
+void tiltyard_shared_set_root(TiltyardSharedArena *arena, TiltyardSharedHandle root)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SHARED_SET_ROOT, true);
+		return;
+	}
+
+	atomic_store_explicit(&arena->header->root, root, memory_order_release);
+}
+
+/* Returns the root object published with 'tiltyard_shared_set_root'.
+ *
+ * Returns:
+ * - The handle of the root object.
+ * - 0 if no root object was published since the arena was created or reset.
+ */
+TiltyardSharedHandle tiltyard_shared_get_root(TiltyardSharedArena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SHARED_GET_ROOT, true);
+		return 0;
+	}
+
+	return atomic_load_explicit(&arena->header->root, memory_order_acquire);
+}
+
+/* Resets the offset of the shared arena to 0 and starts a new generation.
+ *
+ * The generation is incremented before anything else, so every handle made
+ * before becomes invalid, in every process, before its memory is reused.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - No process may allocate from the arena while it is reset, it is
+ *   called by the producer between two batches.
+ * - Consumers still reading the last batch see their handles become
+ *   invalid, see 'tiltyard_shared_valid'.
+ */
+void tiltyard_shared_reset(TiltyardSharedArena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SHARED_RESET, true);
+		return;
+	}
+
+	TiltyardSharedHeader *header = arena->header;
+	atomic_fetch_add_explicit(&header->generation, 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	uint64_t used = atomic_load_explicit(&header->offset, memory_order_relaxed);
+	if (used > header->capacity) used = header->capacity;
+	if (used > atomic_load_explicit(&header->high_water, memory_order_relaxed))
+		atomic_store_explicit(&header->high_water, used, memory_order_relaxed);
+
+	atomic_store_explicit(&header->root, 0, memory_order_relaxed);
+	atomic_store_explicit(&header->offset, 0, memory_order_release);
+}
+
+/* Unmaps the shared arena from this process and frees it.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - If this process created the arena with a name, the name is removed,
+ *   the memory is freed once every process unmapped it.
+ */
+void tiltyard_shared_destroy(TiltyardSharedArena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SHARED_DESTROY, false);
+		return;
+	}
+
+	munmap(arena->header, arena->mapped_size);
+	close(arena->fd);
+	if (arena->name) {
+		shm_unlink(arena->name);
+		free(arena->name);
+	}
+	free(arena);
+}
+
+/* Return the file descriptor of the shared memory of the shared arena.
+ *
+ * Returns:
+ * - The file descriptor, to be passed to other processes, over a unix
+ *   socket with SCM_RIGHTS or by fork, and mapped with 'tiltyard_shared_open_fd'.
+ * - -1 if 'arena' is NULL.
+ *
+ * Notes:
+ * - The descriptor belongs to the arena, and 'tiltyard_shared_open_fd' takes over
+ *   the one it is given, so a process inheriting it by fork must give it a dup.
+ */
+int tiltyard_shared_get_fd(TiltyardSharedArena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SHARED_GET_FD, true);
+		return -1;
+	}
+
+	return arena->fd;
+}
+
+/* Return the current generation of the shared arena, the amount of times it was reset.
+ *
+ * Returns:
+ * - 0 if 'arena' is NULL.
+ * - The generation of the arena otherwise.
+ *
+ * Notes:
+ *  - This function is meant to be used as a way to debug
+ *  the yards already created and it will not affect nor change
+ *  any aspect of the arena.
+ */
+uint64_t tiltyard_shared_get_generation(TiltyardSharedArena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SHARED_GET_GENERATION, true);
+		return 0;
+	}
+
+	return atomic_load_explicit(&arena->header->generation, memory_order_relaxed);
+}
+
+/* Return all the stats of the shared arena.
+ *
+ * Returns:
+ * - TiltyardStats with all values zeroed if 'arena' is null.
+ * - TiltyardStats with all arena's stats if 'arena' is not null.
+ *
+ * Notes:
+ * - The stats are the ones of every process allocating from the arena.
+ * - The last allocation is not tracked by shared arenas, so
+ *   last_alloc_offset is always 0.
+ */
+TiltyardStats tiltyard_shared_get_stats(TiltyardSharedArena *arena)
+{
+	TiltyardStats stats = { 0 };
+
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SHARED_GET_STATS, true);
+		return stats;
+	}
+
+	TiltyardSharedHeader *header = arena->header;
+	size_t used = (size_t)atomic_load_explicit(&header->offset, memory_order_relaxed);
+	if (used > arena->capacity) used = arena->capacity;
+	size_t high_water = (size_t)atomic_load_explicit(&header->high_water, memory_order_relaxed);
+
+	stats.capacity = arena->capacity;
+	stats.used = used;
+	stats.available = arena->capacity - used;
+	stats.high_water = used > high_water ? used : high_water;
+	stats.alloc_count = (size_t)atomic_load_explicit(&header->alloc_count, memory_order_relaxed);
+	stats.block_count = 1;
+	stats.committed = arena->capacity;
+	return stats;
+}
@@ -0,0 +1,385 @@
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "../include/tiltyard_API.h"
+#include "../include/tiltyard_Error.h"
+#include "../include/tiltyard_Snapshot.h"
+
+static TiltyardSnapshot *_Atomic open_snapshots[TILTYARD_SNAPSHOT_MAX];
+static pthread_mutex_t snapshot_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool handler_installed;
+static struct sigaction previous_action;
+
+/* States of a protected page in 'claims'. */
+#define TILTYARD_SNAPSHOT_PROTECTED 0
+#define TILTYARD_SNAPSHOT_SAVING 1
+#define TILTYARD_SNAPSHOT_SAVED 2
+
+/* Returns the index in 'claims' of the protected page 'page'. A page in
+ * both ranges, when the offset and the top share it, is in the low one.
+ */
+static size_t tiltyard_snapshot_page_index(const TiltyardSnapshot *snapshot, const uint8_t *page)
+{
+	if (page >= snapshot->low_beg && page < snapshot->low_end)
+		return (size_t)(page - snapshot->low_beg) / snapshot->page_size;
+
+	return (size_t)(snapshot->low_end - snapshot->low_beg) / snapshot->page_size +
+	       (size_t)(page - snapshot->high_beg) / snapshot->page_size;
+}
+
+/* Saves the page of 'snapshot' holding 'addr' and lets it be written.
+ *
+ * Threads can fault on the same page at the same time, so the first one
+ * claims the page and takes the next slot of 'copies', and the others
+ * wait until the page is saved and writable, then write again.
+ *
+ * Returns:
+ * - true if 'addr' is in a page protected by 'snapshot'.
+ * - false otherwise.
+ */
+static bool tiltyard_snapshot_save_page(TiltyardSnapshot *snapshot, uint8_t *addr)
+{
+	if ((addr < snapshot->low_beg || addr >= snapshot->low_end) &&
+	    (addr < snapshot->high_beg || addr >= snapshot->high_end))
+		return false;
+
+	uint8_t *page = (uint8_t *)((uintptr_t)addr & ~(uintptr_t)(snapshot->page_size - 1));
+	atomic_uchar *claim = &snapshot->claims[tiltyard_snapshot_page_index(snapshot, page)];
+
+	unsigned char state = TILTYARD_SNAPSHOT_PROTECTED;
+	if (!atomic_compare_exchange_strong_explicit(claim, &state, TILTYARD_SNAPSHOT_SAVING,
+						     memory_order_acquire, memory_order_acquire)) {
+		while (atomic_load_explicit(claim, memory_order_acquire) != TILTYARD_SNAPSHOT_SAVED)
+			;
+		return true;
+	}
+
+	/* Every page is claimed once, so there always is a free slot. */
+	size_t slot = atomic_fetch_add_explicit(&snapshot->page_count, 1, memory_order_relaxed);
+	if (slot >= snapshot->max_pages)
+		abort();
+
+	memcpy(snapshot->copies + slot * snapshot->page_size, page, snapshot->page_size);
+	snapshot->pages[slot] = page;
+	mprotect(page, snapshot->page_size, PROT_READ | PROT_WRITE);
+	atomic_store_explicit(claim, TILTYARD_SNAPSHOT_SAVED, memory_order_release);
+	return true;
+}
+
+/* Copies 'page' to the next slot of 'copies' when it is in a range of
+ * 'snapshot' and also holds memory of other objects than the arena, so it
+ * is saved right away and never protected: the arena's own struct or any
+ * other object written while the snapshot is open can live in it.
+ *
+ * Returns:
+ * - Nothing.
+ */
+static void tiltyard_snapshot_save_edge(TiltyardSnapshot *snapshot, uint8_t *page)
+{
+	uint8_t *arena_beg = snapshot->arena->base;
+	uint8_t *arena_end = arena_beg + snapshot->arena->capacity;
+
+	if (page >= arena_beg && page + snapshot->page_size <= arena_end)
+		return;
+
+	if ((page < snapshot->low_beg || page >= snapshot->low_end) &&
+	    (page < snapshot->high_beg || page >= snapshot->high_end))
+		return;
+
+	atomic_uchar *claim = &snapshot->claims[tiltyard_snapshot_page_index(snapshot, page)];
+	if (atomic_load_explicit(claim, memory_order_relaxed) == TILTYARD_SNAPSHOT_SAVED)
+		return;
+
+	size_t slot = snapshot->edge_count++;
+	memcpy(snapshot->copies + slot * snapshot->page_size, page, snapshot->page_size);
+	snapshot->pages[slot] = page;
+	atomic_store_explicit(claim, TILTYARD_SNAPSHOT_SAVED, memory_order_relaxed);
+}
+
+/* Lets the pages saved by 'tiltyard_snapshot_save_edge' be written again.
+ *
+ * Returns:
+ * - Nothing.
+ */
+static void tiltyard_snapshot_release_edges(TiltyardSnapshot *snapshot)
+{
+	for (size_t i = 0; i < snapshot->edge_count; i++)
+		mprotect(snapshot->pages[i], snapshot->page_size, PROT_READ | PROT_WRITE);
+}
+
+/* Handles the writes to the pages protected by the open snapshots,
+ * every other fault goes to the handler there was before.
+ */
+static void tiltyard_snapshot_handler(int sig, siginfo_t *info, void *context)
+{
+	uint8_t *addr = info->si_addr;
+
+	for (size_t i = 0; i < TILTYARD_SNAPSHOT_MAX; i++) {
+		TiltyardSnapshot *snapshot = atomic_load_explicit(&open_snapshots[i], memory_order_acquire);
+		if (snapshot && tiltyard_snapshot_save_page(snapshot, addr))
+			return;
+	}
+
+	if (previous_action.sa_flags & SA_SIGINFO) {
+		previous_action.sa_sigaction(sig, info, context);
+	} else if (previous_action.sa_handler == SIG_DFL || previous_action.sa_handler == SIG_IGN) {
+		/* The faulting instruction runs again and is handled as before. */
+		sigaction(SIGSEGV, &previous_action, NULL);
+	} else {
+		previous_action.sa_handler(sig);
+	}
+}
+
+/* Protects the pages in [beg, end) from writes.
+ *
+ * Returns:
+ * - true if the pages were protected or the range is empty.
+ * - false if mprotect failed.
+ */
+static bool tiltyard_snapshot_protect(uint8_t *beg, uint8_t *end, int prot)
+{
+	return beg >= end || mprotect(beg, (size_t)(end - beg), prot) == 0;
+}
+
+/* Takes a snapshot of the contents and the state of the arena.
+ *
+ * Instead of copying the arena, the pages holding its allocations, the
+ * ones below its offset and above its top, are write protected, and each
+ * of them is copied the first time it is written afterwards. Taking,
+ * restoring and ending the snapshot cost time proportional to the pages
+ * written since, not to the arena's capacity.
+ *
+ * Returns:
+ * - A pointer to the snapshot.
+ * - NULL if 'arena' is NULL, of an unsupported kind, already has an open
+ *   snapshot, or its pages could not be protected.
+ *
+ * Notes:
+ * - Only fixed and virtual arenas that do not release pages to the OS,
+ *   see 'tiltyard_set_decommit' and 'tiltyard_set_clean', are supported,
+ *   and neither setting can be turned on until the snapshot ends.
+ * - The write faults are caught through a SIGSEGV handler, installed
+ *   the first time, which passes every other fault to the previous one.
+ * - System calls that write to a protected page, like read(2), fail
+ *   with EFAULT instead of faulting, write to the page first.
+ * - Large allocations freed while the snapshot is open are not brought
+ *   back, see 'tiltyard_set_large_threshold'.
+ * - The first and last pages, when the arena shares them with other
+ *   objects, are copied right away instead of being protected.
+ */
+TiltyardSnapshot *tiltyard_snapshot_begin(Arena *arena)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SNAPSHOT_BEGIN, true);
+		return NULL;
+	}
+
+	if ((arena->kind != TILTYARD_FIXED_ARENA && arena->kind != TILTYARD_VIRTUAL_ARENA) ||
+	    arena->decommit_mode != TILTYARD_DECOMMIT_NEVER || arena->clean_drop_pages) {
+		tiltyard_handle_error(UNSUPPORTED_ARENA_KIND, TILTYARD_SNAPSHOT_BEGIN, true);
+		return NULL;
+	}
+
+	long page_size = sysconf(_SC_PAGESIZE);
+	size_t page = page_size > 0 ? (size_t)page_size : 4096;
+
+	uintptr_t mask = (uintptr_t)page - 1;
+	uintptr_t base = (uintptr_t)arena->base;
+	uint8_t *low_beg = (uint8_t *)(base & ~mask);
+	uint8_t *low_end = arena->offset == 0 ? low_beg : (uint8_t *)((base + arena->offset + mask) & ~mask);
+	uint8_t *high_beg = (uint8_t *)((base + arena->top) & ~mask);
+	uint8_t *high_end = arena->top == arena->capacity ? high_beg : (uint8_t *)((base + arena->capacity + mask) & ~mask);
+	size_t max_pages = (size_t)(low_end - low_beg) / page + (size_t)(high_end - high_beg) / page;
+
+	/* The snapshot and its index come first, the copies are only committed as pages are saved. */
+	size_t index_size = (sizeof(TiltyardSnapshot) + max_pages * (sizeof(uint8_t *) + sizeof(atomic_uchar)) + mask) & ~mask;
+	size_t storage_size = index_size + max_pages * page;
+	void *storage = mmap(NULL, storage_size, PROT_READ | PROT_WRITE,
+			     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (storage == MAP_FAILED) {
+		tiltyard_handle_error(SNAPSHOT_FAILED, TILTYARD_SNAPSHOT_BEGIN, true);
+		return NULL;
+	}
+
+	TiltyardSnapshot *snapshot = storage;
+	snapshot->arena = arena;
+	snapshot->saved = *arena;
+	snapshot->low_beg = low_beg;
+	snapshot->low_end = low_end;
+	snapshot->high_beg = high_beg;
+	snapshot->high_end = high_end;
+	snapshot->pages = (uint8_t **)(void *)(snapshot + 1);
+	snapshot->claims = (atomic_uchar *)(void *)(snapshot->pages + max_pages);
+	snapshot->copies = (uint8_t *)storage + index_size;
+	snapshot->edge_count = 0;
+	snapshot->max_pages = max_pages;
+	snapshot->page_size = page;
+	snapshot->storage_size = storage_size;
+
+	tiltyard_snapshot_save_edge(snapshot, low_beg);
+	if (low_end > low_beg) tiltyard_snapshot_save_edge(snapshot, low_end - page);
+	tiltyard_snapshot_save_edge(snapshot, high_beg);
+	if (high_end > high_beg) tiltyard_snapshot_save_edge(snapshot, high_end - page);
+	atomic_init(&snapshot->page_count, snapshot->edge_count);
+
+	pthread_mutex_lock(&snapshot_lock);
+
+	bool failed = false;
+	snapshot->slot = TILTYARD_SNAPSHOT_MAX;
+	for (size_t i = 0; i < TILTYARD_SNAPSHOT_MAX; i++) {
+		TiltyardSnapshot *open = atomic_load_explicit(&open_snapshots[i], memory_order_relaxed);
+		if (open && open->arena == arena) failed = true;
+		if (!open && snapshot->slot == TILTYARD_SNAPSHOT_MAX) snapshot->slot = i;
+	}
+
+	if (!failed && snapshot->slot != TILTYARD_SNAPSHOT_MAX && !handler_installed) {
+		struct sigaction action;
+		memset(&action, 0, sizeof(action));
+		action.sa_sigaction = tiltyard_snapshot_handler;
+		action.sa_flags = SA_SIGINFO | SA_RESTART;
+		sigemptyset(&action.sa_mask);
+		handler_installed = sigaction(SIGSEGV, &action, &previous_action) == 0;
+	}
+
+	if (!failed && snapshot->slot != TILTYARD_SNAPSHOT_MAX && handler_installed) {
+		atomic_store_explicit(&open_snapshots[snapshot->slot], snapshot, memory_order_release);
+		arena->snapshot_open = true;
+		failed = !tiltyard_snapshot_protect(snapshot->low_beg, snapshot->low_end, PROT_READ) ||
+			 !tiltyard_snapshot_protect(snapshot->high_beg, snapshot->high_end, PROT_READ);
+		tiltyard_snapshot_release_edges(snapshot);
+		if (failed) {
+			tiltyard_snapshot_protect(snapshot->low_beg, snapshot->low_end, PROT_READ | PROT_WRITE);
+			atomic_store_explicit(&open_snapshots[snapshot->slot], NULL, memory_order_release);
+			arena->snapshot_open = false;
+		}
+	} else {
+		failed = true;
+	}
+
+	pthread_mutex_unlock(&snapshot_lock);
+
+	if (failed) {
+		munmap(storage, storage_size);
+		tiltyard_handle_error(SNAPSHOT_FAILED, TILTYARD_SNAPSHOT_BEGIN, true);
+		return NULL;
+	}
+
+	return snapshot;
+}
+
+/* Puts the arena back as it was when the snapshot was taken.
+ *
+ * The pages written since are copied back and protected again, and the
+ * arena's offset, top and stats are restored, so everything allocated
+ * since is freed and everything written since is undone.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - The snapshot stays open, it can be restored again later.
+ * - Only the bytes of the arena's memory are copied back, bytes of
+ *   other objects sharing its first or last page are kept.
+ */
+void tiltyard_snapshot_restore(TiltyardSnapshot *snapshot)
+{
+	if (!snapshot) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SNAPSHOT_RESTORE, true);
+		return;
+	}
+
+	Arena *arena = snapshot->arena;
+	uint8_t *arena_beg = arena->base;
+	uint8_t *arena_end = arena->base + arena->capacity;
+
+	size_t page_count = atomic_load_explicit(&snapshot->page_count, memory_order_acquire);
+	for (size_t i = 0; i < page_count; i++) {
+		uint8_t *page = snapshot->pages[i];
+		uint8_t *copy = snapshot->copies + i * snapshot->page_size;
+		uint8_t *beg = page < arena_beg ? arena_beg : page;
+		uint8_t *end = page + snapshot->page_size > arena_end ? arena_end : page + snapshot->page_size;
+
+		memcpy(beg, copy + (beg - page), (size_t)(end - beg));
+		if (i < snapshot->edge_count)
+			continue;
+
+		mprotect(page, snapshot->page_size, PROT_READ);
+		atomic_store_explicit(&snapshot->claims[tiltyard_snapshot_page_index(snapshot, page)],
+				      TILTYARD_SNAPSHOT_PROTECTED, memory_order_relaxed);
+	}
+	atomic_store_explicit(&snapshot->page_count, snapshot->edge_count, memory_order_release);
+
+	/* Frees the large allocations made since, before the offset goes back. */
+	if (arena->offset >= snapshot->saved.offset)
+		tiltyard_reset_to(arena, snapshot->saved.offset);
+
+	/* Bytes written above the offset since are not copied back. */
+	size_t dirty = arena->offset > arena->dirty_high_water ? arena->offset : arena->dirty_high_water;
+	size_t top_dirty = arena->top < arena->top_dirty ? arena->top : arena->top_dirty;
+
+	arena->offset = snapshot->saved.offset;
+	arena->last_alloc_offset = snapshot->saved.last_alloc_offset;
+	arena->high_water = snapshot->saved.high_water;
+	arena->alloc_count = snapshot->saved.alloc_count;
+	arena->top = snapshot->saved.top;
+	arena->top_high_water = snapshot->saved.top_high_water;
+	arena->top_alloc_count = snapshot->saved.top_alloc_count;
+	arena->dirty_high_water = dirty > snapshot->saved.dirty_high_water ? dirty : snapshot->saved.dirty_high_water;
+	arena->top_dirty = top_dirty < snapshot->saved.top_dirty ? top_dirty : snapshot->saved.top_dirty;
+	if (arena->kind == TILTYARD_FIXED_ARENA)
+		arena->limit = snapshot->saved.limit;
+}
+
+/* Ends the snapshot, keeping every change made to the arena since it was taken.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - The pages of the arena are writable again and the snapshot is unmapped.
+ */
+void tiltyard_snapshot_end(TiltyardSnapshot *snapshot)
+{
+	if (!snapshot) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SNAPSHOT_END, true);
+		return;
+	}
+
+	pthread_mutex_lock(&snapshot_lock);
+	tiltyard_snapshot_protect(snapshot->low_beg, snapshot->low_end, PROT_READ | PROT_WRITE);
+	tiltyard_snapshot_protect(snapshot->high_beg, snapshot->high_end, PROT_READ | PROT_WRITE);
+	atomic_store_explicit(&open_snapshots[snapshot->slot], NULL, memory_order_release);
+	snapshot->arena->snapshot_open = false;
+	pthread_mutex_unlock(&snapshot_lock);
+
+	munmap(snapshot, snapshot->storage_size);
+}
+
+/* Return the amount of pages written since the snapshot was taken or last restored.
+ *
+ * Returns:
+ * - 0 if 'snapshot' is NULL.
+ * - The amount of pages saved by the snapshot otherwise.
+ *
+ * Notes:
+ *  - This function is meant to be used as a way to debug
+ *  the yards already created and it will not affect nor change
+ *  any aspect of the arena.
+ */
+size_t tiltyard_snapshot_get_page_count(TiltyardSnapshot *snapshot)
+{
+	if (!snapshot) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_SNAPSHOT_GET_PAGE_COUNT, true);
+		return 0;
+	}
+
+	return atomic_load_explicit(&snapshot->page_count, memory_order_relaxed) - snapshot->edge_count;
+}
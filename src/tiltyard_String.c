@@ -0,0 +1,177 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../include/tiltyard_API.h"
+#include "../include/tiltyard_Error.h"
+#include "../include/tiltyard_String.h"
+
+#define TILTYARD_STRING_MIN_CAPACITY 32
+
+/* Makes room in the string for 'extra' more characters and its terminator.
+ *
+ * The capacity is at least doubled every time the string grows, and the
+ * characters are resized with 'tiltyard_realloc', so they are only copied
+ * when the string is not the last allocation of the arena.
+ *
+ * Returns:
+ * - true if the string has room for 'extra' more characters.
+ * - false if there is not enough space in the arena.
+ */
+static bool tiltyard_string_reserve(TiltyardString *string, size_t extra)
+{
+	if (extra < string->capacity - string->length)
+		return true;
+
+	if (extra > SIZE_MAX - 1 - string->length) {
+		tiltyard_handle_error(EXCEEDED_ARENA_CAPACITY, TILTYARD_STRING_APPEND, true);
+		return false;
+	}
+
+	size_t needed = string->length + extra + 1;
+	size_t new_capacity = string->capacity > SIZE_MAX / 2 ? SIZE_MAX : string->capacity * 2;
+	if (new_capacity < needed) new_capacity = needed;
+	if (new_capacity < TILTYARD_STRING_MIN_CAPACITY) new_capacity = TILTYARD_STRING_MIN_CAPACITY;
+
+	char *data = tiltyard_realloc_aligned(string->arena, string->data, string->capacity, new_capacity, 1);
+	if (!data) return false;
+
+	string->data = data;
+	string->capacity = new_capacity;
+	return true;
+}
+
+/* Initializes an empty string in 'arena'.
+ *
+ * Reserves room for 'capacity' characters, plus the terminator.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - The string lives in the arena, so it becomes invalid when the arena
+ *   is reset below it, and it does not need to be freed.
+ * - The string grows in place while it is the last allocation of the arena,
+ *   so building one string at a time avoids copying its characters.
+ */
+void tiltyard_string_init(TiltyardString *string, Arena *arena, size_t capacity)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_STRING_INIT, true);
+		return;
+	}
+
+	string->arena = arena;
+	string->data = NULL;
+	string->length = 0;
+	string->capacity = 0;
+
+	if (tiltyard_string_reserve(string, capacity))
+		string->data[0] = '\0';
+}
+
+/* Appends 'length' characters of 'text' to the string.
+ *
+ * Returns:
+ * - true if the characters were appended.
+ * - false if there is not enough space in the arena.
+ */
+bool tiltyard_string_append(TiltyardString *string, const char *text, size_t length)
+{
+	if (!tiltyard_string_reserve(string, length))
+		return false;
+
+	memcpy(string->data + string->length, text, length);
+	string->length += length;
+	string->data[string->length] = '\0';
+	return true;
+}
+
+/* Appends the null-terminated 'text' to the string. */
+bool tiltyard_string_append_cstr(TiltyardString *string, const char *text)
+{
+	return tiltyard_string_append(string, text, strlen(text));
+}
+
+/* Appends the character 'c' to the string. */
+bool tiltyard_string_append_char(TiltyardString *string, char c)
+{
+	return tiltyard_string_append(string, &c, 1);
+}
+
+/* Appends the text formatted by 'format' and the arguments to the string.
+ *
+ * Same behavior as 'tiltyard_string_appendv' with variadic arguments.
+ */
+bool tiltyard_string_appendf(TiltyardString *string, const char *format, ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	bool appended = tiltyard_string_appendv(string, format, args);
+	va_end(args);
+	return appended;
+}
+
+/* Appends the text formatted by 'format' and 'args' to the string.
+ *
+ * The text is formatted straight into the string's spare capacity,
+ * and formatted a second time only when it does not fit.
+ *
+ * Returns:
+ * - true if the text was appended.
+ * - false if the format is invalid or there is not enough space in the arena,
+ *   the string is left as it was.
+ */
+bool tiltyard_string_appendv(TiltyardString *string, const char *format, va_list args)
+{
+	va_list retry;
+	va_copy(retry, args);
+
+	size_t room = string->capacity - string->length;
+	int written = vsnprintf(room ? string->data + string->length : NULL, room, format, args);
+	if (written < 0) {
+		va_end(retry);
+		if (room) string->data[string->length] = '\0';
+		tiltyard_handle_error(INVALID_FORMAT, TILTYARD_STRING_APPENDF, false);
+		return false;
+	}
+
+	if ((size_t)written >= room) {
+		if (!tiltyard_string_reserve(string, (size_t)written)) {
+			va_end(retry);
+			/* Drop the truncated text written in the spare capacity. */
+			if (room) string->data[string->length] = '\0';
+			return false;
+		}
+		vsnprintf(string->data + string->length, (size_t)written + 1, format, retry);
+	}
+
+	va_end(retry);
+	string->length += (size_t)written;
+	return true;
+}
+
+/* Gives the unused capacity of the string back to the arena
+ * and returns its characters.
+ *
+ * Returns:
+ * - The null-terminated characters of the string.
+ * - NULL if there is not enough space in the arena for an empty string.
+ *
+ * Notes:
+ * - Only the string that is the last allocation of the arena gives
+ *   memory back, the unused capacity of any other string is lost.
+ * - The string can still be appended to afterwards.
+ */
+char *tiltyard_string_finish(TiltyardString *string)
+{
+	if (!string->data && !tiltyard_string_reserve(string, 0))
+		return NULL;
+
+	tiltyard_realloc_aligned(string->arena, string->data, string->capacity, string->length + 1, 1);
+	string->capacity = string->length + 1;
+	return string->data;
+}
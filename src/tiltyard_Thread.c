@@ -0,0 +1,312 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../include/tiltyard_API.h"
+#include "../include/tiltyard_Error.h"
+#include "../include/tiltyard_Thread.h"
+
+#define TILTYARD_THREAD_BLOCK_CAPACITY ((size_t)64 * 1024)
+
+static TiltyardBlockPool global_pool;
+
+static atomic_size_t thread_block_capacity = TILTYARD_THREAD_BLOCK_CAPACITY;
+static atomic_size_t thread_max_capacity = SIZE_MAX;
+
+static pthread_once_t thread_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t thread_key;
+
+static _Thread_local Arena *thread_arena;
+
+/* Bits of a head of the pool holding the pointer to the top block,
+ * the bits above them hold the tag.
+ */
+#if UINTPTR_MAX == UINT32_MAX
+#define TILTYARD_BLOCK_POOL_POINTER_BITS 32
+#else
+#define TILTYARD_BLOCK_POOL_POINTER_BITS 48
+#endif
+
+#define TILTYARD_BLOCK_POOL_POINTER_MASK (((uint64_t)1 << TILTYARD_BLOCK_POOL_POINTER_BITS) - 1)
+
+/* Returns the block on top of the stack whose head is 'head'. */
+static TiltyardBlock *tiltyard_block_pool_top(uint64_t head)
+{
+	return (TiltyardBlock *)(uintptr_t)(head & TILTYARD_BLOCK_POOL_POINTER_MASK);
+}
+
+/* Returns the head replacing 'head' with 'block' on top of the stack, with the tag bumped. */
+static uint64_t tiltyard_block_pool_head(TiltyardBlock *block, uint64_t head)
+{
+	uint64_t tag = (head | TILTYARD_BLOCK_POOL_POINTER_MASK) + 1;
+	return tag | (uint64_t)(uintptr_t)block;
+}
+
+/* Returns the size class of a block holding 'capacity' bytes. */
+static size_t tiltyard_block_pool_class(size_t capacity)
+{
+	return (size_t)(63 - __builtin_clzll((unsigned long long)capacity));
+}
+
+/* Pushes 'block' on top of the stack of its size class.
+ *
+ * Returns:
+ * - Nothing.
+ */
+static void tiltyard_block_pool_push_one(TiltyardBlockPool *pool, TiltyardBlock *block)
+{
+	_Atomic uint64_t *stack = &pool->heads[tiltyard_block_pool_class(block->capacity)];
+	uint64_t head = atomic_load_explicit(stack, memory_order_relaxed);
+
+	do {
+		block->prev = tiltyard_block_pool_top(head);
+	} while (!atomic_compare_exchange_weak_explicit(stack, &head, tiltyard_block_pool_head(block, head),
+							memory_order_release, memory_order_relaxed));
+}
+
+/* Pops the block on top of the stack of the size class 'size_class'.
+ *
+ * Returns:
+ * - The block removed from the stack.
+ * - NULL if the stack is empty.
+ *
+ * Notes:
+ * - The top block is read before the compare-and-swap that removes it,
+ *   which fails if another thread popped it in between. The pop is
+ *   counted in 'poppers' meanwhile, so that block is not freed under it,
+ *   see 'tiltyard_block_pool_push'.
+ */
+static TiltyardBlock *tiltyard_block_pool_pop_one(TiltyardBlockPool *pool, size_t size_class)
+{
+	_Atomic uint64_t *stack = &pool->heads[size_class];
+
+	atomic_fetch_add_explicit(&pool->poppers, 1, memory_order_seq_cst);
+	uint64_t head = atomic_load_explicit(stack, memory_order_seq_cst);
+
+	TiltyardBlock *block = tiltyard_block_pool_top(head);
+	while (block && !atomic_compare_exchange_weak_explicit(stack, &head, tiltyard_block_pool_head(block->prev, head),
+							       memory_order_seq_cst, memory_order_seq_cst))
+		block = tiltyard_block_pool_top(head);
+
+	atomic_fetch_sub_explicit(&pool->poppers, 1, memory_order_release);
+	return block;
+}
+
+/* Counts one more block in the pool, unless it is full.
+ *
+ * Returns:
+ * - true if the block was counted.
+ * - false if the pool already holds TILTYARD_BLOCK_POOL_MAX_BLOCKS blocks.
+ */
+static bool tiltyard_block_pool_reserve(TiltyardBlockPool *pool)
+{
+	size_t count = atomic_load_explicit(&pool->count, memory_order_relaxed);
+
+	do {
+		if (count >= TILTYARD_BLOCK_POOL_MAX_BLOCKS)
+			return false;
+	} while (!atomic_compare_exchange_weak_explicit(&pool->count, &count, count + 1,
+							memory_order_relaxed, memory_order_relaxed));
+
+	return true;
+}
+
+/* Pushes every block of the list 'blocks', linked through their 'prev' field, to the pool.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Safe to call from any thread at the same time as any
+ *   other function of the pool, but 'tiltyard_block_pool_drain'.
+ * - Blocks pushed once the pool holds TILTYARD_BLOCK_POOL_MAX_BLOCKS
+ *   blocks are freed instead, unless another thread is popping, which
+ *   may still read them, then they are kept past the limit.
+ * - Blocks whose address does not fit in a head of the pool are freed.
+ */
+void tiltyard_block_pool_push(TiltyardBlockPool *pool, TiltyardBlock *blocks)
+{
+	while (blocks) {
+		TiltyardBlock *block = blocks;
+		blocks = blocks->prev;
+
+		if (((uint64_t)(uintptr_t)block & ~TILTYARD_BLOCK_POOL_POINTER_MASK) != 0) {
+			free(block);
+			continue;
+		}
+
+		if (!tiltyard_block_pool_reserve(pool)) {
+			if (atomic_load_explicit(&pool->poppers, memory_order_seq_cst) == 0) {
+				free(block);
+				continue;
+			}
+			atomic_fetch_add_explicit(&pool->count, 1, memory_order_relaxed);
+		}
+
+		tiltyard_block_pool_push_one(pool, block);
+	}
+}
+
+/* Pops from the pool a block holding at least 'needed'
+ * bytes and at most 'room' bytes.
+ *
+ * Only the top block of each size class that can hold such a block
+ * is looked at, from the smallest class up, and the ones that do not
+ * fit are pushed back, so a pop never walks a whole stack.
+ *
+ * Returns:
+ * - The block removed from the pool if one fits.
+ * - NULL if no block on top of those classes fits.
+ *
+ * Notes:
+ * - Safe to call from any thread at the same time as any
+ *   other function of the pool, but 'tiltyard_block_pool_drain'.
+ * - The returned block is not linked to any arena.
+ */
+TiltyardBlock *tiltyard_block_pool_pop(TiltyardBlockPool *pool, size_t needed, size_t room)
+{
+	if (needed > room) return NULL;
+
+	size_t first = needed ? tiltyard_block_pool_class(needed) : 0;
+	size_t last = tiltyard_block_pool_class(room);
+
+	for (size_t size_class = first; size_class <= last; size_class++) {
+		TiltyardBlock *block = tiltyard_block_pool_pop_one(pool, size_class);
+		if (!block) continue;
+
+		if (block->capacity >= needed && block->capacity <= room) {
+			atomic_fetch_sub_explicit(&pool->count, 1, memory_order_relaxed);
+			return block;
+		}
+
+		tiltyard_block_pool_push_one(pool, block);
+	}
+
+	return NULL;
+}
+
+/* Frees every block in the pool.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - No other thread may pop from or push to the pool while it is
+ *   drained, a pop could read a block being freed.
+ */
+void tiltyard_block_pool_drain(TiltyardBlockPool *pool)
+{
+	for (size_t size_class = 0; size_class < TILTYARD_BLOCK_POOL_CLASSES; size_class++) {
+		TiltyardBlock *block = tiltyard_block_pool_pop_one(pool, size_class);
+
+		while (block) {
+			free(block);
+			atomic_fetch_sub_explicit(&pool->count, 1, memory_order_relaxed);
+			block = tiltyard_block_pool_pop_one(pool, size_class);
+		}
+	}
+}
+
+/* Returns the amount of blocks in the pool.
+ *
+ * Notes:
+ * - The amount may already be outdated when it is returned
+ *   if other threads are using the pool.
+ */
+size_t tiltyard_block_pool_count(TiltyardBlockPool *pool)
+{
+	return atomic_load_explicit(&pool->count, memory_order_relaxed);
+}
+
+/* Returns the pool shared by the arenas of every thread. */
+TiltyardBlockPool *tiltyard_global_block_pool(void)
+{
+	return &global_pool;
+}
+
+/* Destroys the arena of a thread that is exiting. */
+static void tiltyard_thread_arena_destructor(void *arena)
+{
+	tiltyard_destroy(arena);
+}
+
+static void tiltyard_thread_key_create(void)
+{
+	if (pthread_key_create(&thread_key, tiltyard_thread_arena_destructor) != 0)
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_ARENA, TILTYARD_THREAD_ARENA, true);
+}
+
+/* Sets the capacity of the first block and the max capacity
+ * of the arenas created by 'tiltyard_thread_arena'.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Safe to call while other threads use 'tiltyard_thread_arena',
+ *   but arenas already created keep their configuration, so it is
+ *   meant to be called before any thread uses it.
+ */
+void tiltyard_thread_arena_configure(size_t block_capacity, size_t max_capacity)
+{
+	atomic_store_explicit(&thread_block_capacity, block_capacity, memory_order_relaxed);
+	atomic_store_explicit(&thread_max_capacity, max_capacity, memory_order_relaxed);
+}
+
+/* Returns the arena of the calling thread.
+ *
+ * The arena is a growable arena created the first time a thread calls
+ * this function, whose blocks come from the global block pool and go
+ * back to it when the thread exits or calls 'tiltyard_thread_arena_release'.
+ *
+ * Returns:
+ * - A pointer to the arena of the calling thread.
+ *
+ * Notes:
+ * - Every thread has its own arena, so allocating from it never touches
+ *   memory shared with other threads, only chaining blocks does.
+ * - Resetting the arena keeps one grown block for the next round and
+ *   pushes the others back to the global block pool, so a thread that
+ *   grew once does not hold them until it exits.
+ * - The arena must not be destroyed by the user.
+ */
+Arena *tiltyard_thread_arena(void)
+{
+	if (thread_arena) return thread_arena;
+
+	pthread_once(&thread_key_once, tiltyard_thread_key_create);
+
+	size_t block_capacity = atomic_load_explicit(&thread_block_capacity, memory_order_relaxed);
+	size_t max_capacity = atomic_load_explicit(&thread_max_capacity, memory_order_relaxed);
+	thread_arena = tiltyard_create_pooled(&global_pool, block_capacity, max_capacity);
+	if (thread_arena && pthread_setspecific(thread_key, thread_arena) != 0)
+		tiltyard_handle_error(NOT_ENOUGH_SPACE_FOR_ARENA, TILTYARD_THREAD_ARENA, true);
+
+	return thread_arena;
+}
+
+/* Gives every block of the calling thread's arena back to the global block pool.
+ *
+ * Destroys the arena of the calling thread, so every pointer
+ * into it becomes invalid. A new arena is created the next time
+ * the thread calls 'tiltyard_thread_arena'.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Nothing happens if the calling thread has no arena.
+ */
+void tiltyard_thread_arena_release(void)
+{
+	if (!thread_arena) return;
+
+	if (pthread_setspecific(thread_key, NULL) != 0)
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_THREAD_ARENA_RELEASE, false);
+
+	tiltyard_destroy(thread_arena);
+	thread_arena = NULL;
+}
@@ -0,0 +1,120 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../include/tiltyard_API.h"
+#include "../include/tiltyard_Error.h"
+#include "../include/tiltyard_Vector.h"
+
+#define TILTYARD_VECTOR_MIN_CAPACITY 8
+
+/* Initializes an empty vector of elements of 'element_size' bytes
+ * aligned to 'alignment' in 'arena'.
+ *
+ * Reserves room for 'capacity' elements, if 'capacity' is not 0.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - The vector lives in the arena, so it becomes invalid when the arena
+ *   is reset below it, and it does not need to be freed.
+ * - The vector grows in place while it is the last allocation of the arena,
+ *   so building one vector at a time avoids copying its elements.
+ */
+void tiltyard_vector_init(TiltyardVector *vector, Arena *arena, size_t element_size, size_t alignment, size_t capacity)
+{
+	if (!arena) {
+		tiltyard_handle_error(NULL_POINTER_TO_ARENA, TILTYARD_VECTOR_INIT, true);
+		return;
+	}
+
+	if (element_size == 0)
+		tiltyard_handle_error(SIZE_EQUALS_ZERO, TILTYARD_VECTOR_INIT, true);
+
+	vector->arena = arena;
+	vector->data = NULL;
+	vector->length = 0;
+	vector->capacity = 0;
+	vector->element_size = element_size;
+	vector->alignment = alignment;
+
+	if (capacity)
+		tiltyard_vector_reserve(vector, capacity);
+}
+
+/* Makes room in the vector for at least 'capacity' elements.
+ *
+ * The capacity is at least doubled every time the vector grows, and
+ * the elements are resized with 'tiltyard_realloc_aligned', so they
+ * are only copied when the vector is not the last allocation of the arena.
+ *
+ * Returns:
+ * - true if the vector has room for 'capacity' elements.
+ * - false if there is not enough space in the arena.
+ */
+bool tiltyard_vector_reserve(TiltyardVector *vector, size_t capacity)
+{
+	if (capacity <= vector->capacity)
+		return true;
+
+	size_t new_capacity = vector->capacity > SIZE_MAX / 2 ? SIZE_MAX : vector->capacity * 2;
+	if (new_capacity < capacity) new_capacity = capacity;
+	if (new_capacity < TILTYARD_VECTOR_MIN_CAPACITY) new_capacity = TILTYARD_VECTOR_MIN_CAPACITY;
+
+	if (new_capacity > SIZE_MAX / vector->element_size) {
+		tiltyard_handle_error(EXCEEDED_ARENA_CAPACITY, TILTYARD_VECTOR_RESERVE, true);
+		return false;
+	}
+
+	uint8_t *data = tiltyard_realloc_aligned(vector->arena, vector->data,
+						 vector->capacity * vector->element_size,
+						 new_capacity * vector->element_size, vector->alignment);
+	if (!data) return false;
+
+	vector->data = data;
+	vector->capacity = new_capacity;
+	return true;
+}
+
+/* Slow path of 'tiltyard_vector_push_n', grows the vector and
+ * appends 'count' uninitialized elements to it.
+ *
+ * Returns:
+ * - A pointer to the first element appended.
+ * - NULL if the vector could not grow.
+ */
+void *tiltyard_vector_push_slow(TiltyardVector *vector, size_t count)
+{
+	if (count > SIZE_MAX - vector->length) {
+		tiltyard_handle_error(EXCEEDED_ARENA_CAPACITY, TILTYARD_VECTOR_PUSH_SLOW, true);
+		return NULL;
+	}
+
+	if (!tiltyard_vector_reserve(vector, vector->length + count))
+		return NULL;
+
+	return tiltyard_vector_push_n(vector, count);
+}
+
+/* Gives the unused capacity of the vector back to the arena.
+ *
+ * Returns:
+ * - Nothing.
+ *
+ * Notes:
+ * - Only the vector that is the last allocation of the arena gives
+ *   memory back, the unused capacity of any other vector is lost.
+ */
+void tiltyard_vector_shrink(TiltyardVector *vector)
+{
+	if (!vector->data)
+		return;
+
+	tiltyard_realloc_aligned(vector->arena, vector->data, vector->capacity * vector->element_size,
+				 vector->length * vector->element_size, vector->alignment);
+	vector->capacity = vector->length;
+
+	/* Shrinking to 0 frees the elements, the next push allocates them again. */
+	if (vector->length == 0)
+		vector->data = NULL;
+}